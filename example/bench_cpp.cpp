@@ -0,0 +1,91 @@
+/* C callback path vs. the header-only C++ wrapper on the same log.
+ *
+ *   g++ -O2 -std=c++17 -Iinclude example/bench_cpp.cpp -Lbuild/lib -lstwwsr -lpthread
+ *   ./a.out day.log [rounds]
+ *
+ * Both sides replay with --no-sleep semantics and run the same tiny handler
+ * (count frames, sum bytes, hash the first byte), so the difference is the
+ * per-frame dispatch: msg adapter + indirect call in C, an inlined lambda in C++.
+ * Reading and parsing each line dominate, so expect at most a few percent
+ * (0.5-2% on a 200k-frame log here, within run-to-run noise). Best of `rounds`
+ * runs is reported.
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+#include "stw/replay.hpp"
+
+namespace {
+
+struct totals {
+    std::uint64_t frames = 0;
+    std::uint64_t bytes  = 0;
+    std::uint64_t hash   = 0;
+
+    void add(const char* json, std::size_t len)
+    {
+        frames++;
+        bytes += len;
+        hash   = hash * 31 + static_cast<unsigned char>(len ? json[0] : 0);
+    }
+};
+
+void c_handler(void* user, const char* json, std::size_t len)
+{
+    static_cast<totals*>(user)->add(json, len);
+}
+
+double now_s()
+{
+    using clock = std::chrono::steady_clock;
+    return std::chrono::duration<double>(clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <logfile> [rounds]\n", argv[0]);
+        return 1;
+    }
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    stw_replay_opts_t opt = {};
+    opt.logfile  = argv[1];
+    opt.speed    = 1.0;
+    opt.no_sleep = true;
+
+    double best_c = 1e30, best_cpp = 1e30;
+    totals tc, tcpp;
+    for (int r = 0; r < rounds; r++) {
+        tc       = totals{};
+        double t = now_s();
+        if (stw_replay_run_simple(&opt, c_handler, &tc) != 0) return 1;
+        t = now_s() - t;
+        if (t < best_c) best_c = t;
+
+        tcpp = totals{};
+        t    = now_s();
+        stw::replay rp(opt, [&](std::string_view json) { tcpp.add(json.data(), json.size()); });
+        if (rp.run() != 0) return 1;
+        t = now_s() - t;
+        if (t < best_cpp) best_cpp = t;
+    }
+
+    if (tc.frames != tcpp.frames || tc.hash != tcpp.hash) {
+        std::fprintf(stderr, "mismatch: C %" PRIu64 " frames, C++ %" PRIu64 "\n", tc.frames, tcpp.frames);
+        return 1;
+    }
+    double n = static_cast<double>(tc.frames);
+    std::printf("frames=%" PRIu64 " bytes=%" PRIu64 "\n", tc.frames, tc.bytes);
+    std::printf("C   callback : %.3f s  %.1f ns/frame\n", best_c, best_c / n * 1e9);
+    std::printf("C++ template : %.3f s  %.1f ns/frame  (%+.1f%%)\n",
+                best_cpp, best_cpp / n * 1e9, (best_cpp - best_c) / best_c * 100.0);
+    return 0;
+}
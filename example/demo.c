@@ -20,15 +20,19 @@
    Simplified copy of your cb_receive (adapted signature)
    ===================== */
 
-static stw_timestamp_s_t p_ts = 0, ts = 0;
-static stw_ohlc_t ohlc = {0.0f, 0.0f, 0.0f, 0.0f};
-static stw_candle_s_t candle;
-static stw_resampler_ctx_t rsctx;
+/* All per-session state lives here (no globals), so several sessions can run
+ * side by side, e.g. under stw_replay_runner_run(). */
+typedef struct {
+	stw_timestamp_s_t p_ts, ts;
+	stw_ohlc_t ohlc;
+	stw_candle_s_t candle;
+	stw_resampler_ctx_t rsctx;
+} demo_ctx_t;
 
 static void cb_receive_compat(void* wsi, void* user, void* in, size_t len)
 {
 	(void)wsi;
-	(void)user;
+	demo_ctx_t* C = (demo_ctx_t*)user;
 
 	const char* payload = (const char*)in;
 
@@ -43,27 +47,27 @@ static void cb_receive_compat(void* wsi, void* user, void* in, size_t len)
 	if (response) {
 		const cJSON* b_cast_time = cJSON_GetObjectItemCaseSensitive(response, "BCastTime");
 		if (b_cast_time && cJSON_IsString(b_cast_time) && b_cast_time->valuestring) {
-			p_ts = ts;
-			ts = (stw_timestamp_s_t)strtoull(b_cast_time->valuestring, NULL, 10);
+			C->p_ts = C->ts;
+			C->ts = (stw_timestamp_s_t)strtoull(b_cast_time->valuestring, NULL, 10);
 		}
 		const cJSON* data = cJSON_GetObjectItemCaseSensitive(response, "data");
 		if (data) {
 			const cJSON* ltp = cJSON_GetObjectItemCaseSensitive(data, "ltp");
 			if (ltp && cJSON_IsString(ltp) && ltp->valuestring) {
-				ohlc.close = (float)atof(ltp->valuestring);
-				if (ohlc.open == 0.0f) {
-					ohlc.open = ohlc.high = ohlc.low = ohlc.close;
+				C->ohlc.close = (float)atof(ltp->valuestring);
+				if (C->ohlc.open == 0.0f) {
+					C->ohlc.open = C->ohlc.high = C->ohlc.low = C->ohlc.close;
 				} else {
-					if (ohlc.close > ohlc.high) ohlc.high = ohlc.close;
-					if (ohlc.close < ohlc.low) ohlc.low = ohlc.close;
+					if (C->ohlc.close > C->ohlc.high) C->ohlc.high = C->ohlc.close;
+					if (C->ohlc.close < C->ohlc.low) C->ohlc.low = C->ohlc.close;
 				}
 			}
 		}
 
-		if (ts != p_ts && ts != 0) {
-			stw_append_candle(&candle, &ohlc, ts, 1);
+		if (C->ts != C->p_ts && C->ts != 0) {
+			stw_append_candle(&C->candle, &C->ohlc, C->ts, 1);
 			/* Reset OHLC for next second */
-			ohlc.open = ohlc.high = ohlc.low = ohlc.close;
+			C->ohlc.open = C->ohlc.high = C->ohlc.low = C->ohlc.close;
 		}
 	}
 
@@ -73,8 +77,7 @@ static void cb_receive_compat(void* wsi, void* user, void* in, size_t len)
 /* Adapter from replay → your cb_receive_compat */
 static void adapter_cb(void* user, const char* json, size_t len)
 {
-	(void)user;
-	cb_receive_compat(NULL, NULL, (void*)json, len);
+	cb_receive_compat(NULL, user, (void*)json, len);
 }
 
 static void usage(const char* argv0)
@@ -121,30 +124,32 @@ int main(int argc, char** argv)
 		return 2;
 	}
 
+	demo_ctx_t ctx = {0};
+	stw_candle_s_t* candle = &ctx.candle;
+
 	/* Allocate candle buffer */
-	if (stw_candle_alloc(&candle, cap) != 0) {
+	if (stw_candle_alloc(candle, cap) != 0) {
 		fprintf(stderr, "candle alloc failed\n");
 		return 1;
 	}
-	candle.tf = tf;
-	candle.m_open = stw_nse_start_market_time();
-	candle.m_close = stw_nse_end_market_time();
+	candle->tf = tf;
+	candle->m_open = stw_nse_start_market_time();
+	candle->m_close = stw_nse_end_market_time();
 
 	/* Init (optional) resampler context if your upstream expects TF != 1s */
-	stw_candle_resampler_init(&rsctx, &candle, 1);
-	(void)rsctx; /* shown for completeness */
+	stw_candle_resampler_init(&ctx.rsctx, candle, 1);
 
-	int rc = stw_replay_run_simple(&opt, adapter_cb, NULL);
+	int rc = stw_replay_run_simple(&opt, adapter_cb, &ctx);
 
 	/* Print a small summary */
 	fprintf(stderr,
 		"\nReplayed. Built %zu candles at tf=%us. Last: O=%.2f H=%.2f L=%.2f C=%.2f\n",
-		candle.arr_size, candle.tf,
-		candle.arr_size ? candle.ohlc[candle.arr_size - 1].open : 0.0f,
-		candle.arr_size ? candle.ohlc[candle.arr_size - 1].high : 0.0f,
-		candle.arr_size ? candle.ohlc[candle.arr_size - 1].low : 0.0f,
-		candle.arr_size ? candle.ohlc[candle.arr_size - 1].close : 0.0f);
+		candle->arr_size, candle->tf,
+		candle->arr_size ? candle->ohlc[candle->arr_size - 1].open : 0.0f,
+		candle->arr_size ? candle->ohlc[candle->arr_size - 1].high : 0.0f,
+		candle->arr_size ? candle->ohlc[candle->arr_size - 1].low : 0.0f,
+		candle->arr_size ? candle->ohlc[candle->arr_size - 1].close : 0.0f);
 
-	stw_candle_free(&candle);
+	stw_candle_free(candle);
 	return rc;
 }
@@ -11,31 +11,31 @@
 #include <stw/json.h>
 #include <stw/time.h>
 
-/* Simple OHLC state */
-static stw_ohlc_t ohlc = {0.0f, 0.0f, 0.0f, 0.0f};
-
-/* Candle buffers for multiple TFs */
-static stw_candle_ns_t candle_500us;
-static stw_candle_ns_t candle_500ms;
-static stw_candle_ns_t candle_1s;
-static stw_candle_ns_t candle_3m;
+/* Per-session state: OHLC plus candle buffers for multiple TFs (no globals) */
+typedef struct {
+	stw_ohlc_t ohlc;
+	stw_candle_ns_t candle_500us;
+	stw_candle_ns_t candle_500ms;
+	stw_candle_ns_t candle_1s;
+	stw_candle_ns_t candle_3m;
+} demo_ns_ctx_t;
 
 /* Convert seconds + ltp into OHLC updates */
-static void update_ohlc(float price)
+static void update_ohlc(stw_ohlc_t* ohlc, float price)
 {
-	if (ohlc.open == 0.0f) {
-		ohlc.open = ohlc.high = ohlc.low = ohlc.close = price;
+	if (ohlc->open == 0.0f) {
+		ohlc->open = ohlc->high = ohlc->low = ohlc->close = price;
 	} else {
-		ohlc.close = price;
-		if (price > ohlc.high) ohlc.high = price;
-		if (price < ohlc.low) ohlc.low = price;
+		ohlc->close = price;
+		if (price > ohlc->high) ohlc->high = price;
+		if (price < ohlc->low) ohlc->low = price;
 	}
 }
 
 static void cb_receive_ns(void* wsi, void* user, void* in, size_t len)
 {
 	(void)wsi;
-	(void)user;
+	demo_ns_ctx_t* C = (demo_ns_ctx_t*)user;
 	const char* payload = (const char*)in;
 
 	cJSON* json = cJSON_ParseWithLengthOpts(payload, len, NULL, 0);
@@ -49,12 +49,12 @@ static void cb_receive_ns(void* wsi, void* user, void* in, size_t len)
 			const cJSON* ltp = cJSON_GetObjectItemCaseSensitive(data, "ltp");
 			if (ltp && ltp->valuestring) {
 				float price = (float)atof(ltp->valuestring);
-				update_ohlc(price);
+				update_ohlc(&C->ohlc, price);
 				uint64_t ts_ns = ts_s * 1000000000ull;
-				stw_append_candle_ns(&candle_500us, &ohlc, ts_ns, 500 * 1000ull);
-				stw_append_candle_ns(&candle_500ms, &ohlc, ts_ns, 500 * 1000000ull);
-				stw_append_candle_ns(&candle_1s, &ohlc, ts_ns, 1000000000ull);
-				stw_append_candle_ns(&candle_3m, &ohlc, ts_ns, 180 * 1000000000ull);
+				stw_append_candle_ns(&C->candle_500us, &C->ohlc, ts_ns, 500 * 1000ull);
+				stw_append_candle_ns(&C->candle_500ms, &C->ohlc, ts_ns, 500 * 1000000ull);
+				stw_append_candle_ns(&C->candle_1s, &C->ohlc, ts_ns, 1000000000ull);
+				stw_append_candle_ns(&C->candle_3m, &C->ohlc, ts_ns, 180 * 1000000000ull);
 			}
 		}
 	}
@@ -63,8 +63,7 @@ static void cb_receive_ns(void* wsi, void* user, void* in, size_t len)
 
 static void adapter_cb(void* user, const char* json, size_t len)
 {
-	(void)user;
-	cb_receive_ns(NULL, NULL, (void*)json, len);
+	cb_receive_ns(NULL, user, (void*)json, len);
 }
 
 int main(int argc, char** argv)
@@ -77,20 +76,21 @@ int main(int argc, char** argv)
 	opt.logfile = argv[1];
 	opt.speed = 1.0;
 
-	stw_candle_ns_alloc(&candle_500us, 4096);
-	stw_candle_ns_alloc(&candle_500ms, 4096);
-	stw_candle_ns_alloc(&candle_1s, 4096);
-	stw_candle_ns_alloc(&candle_3m, 4096);
+	demo_ns_ctx_t ctx = {0};
+	stw_candle_ns_alloc(&ctx.candle_500us, 4096);
+	stw_candle_ns_alloc(&ctx.candle_500ms, 4096);
+	stw_candle_ns_alloc(&ctx.candle_1s, 4096);
+	stw_candle_ns_alloc(&ctx.candle_3m, 4096);
 
-	stw_replay_run_simple(&opt, adapter_cb, NULL);
+	stw_replay_run_simple(&opt, adapter_cb, &ctx);
 
-	fprintf(stderr, "500us candles=%zu, 500ms=%zu, 1s=%zu, 3m=%zu\n", candle_500us.arr_size,
-		candle_500ms.arr_size, candle_1s.arr_size, candle_3m.arr_size);
+	fprintf(stderr, "500us candles=%zu, 500ms=%zu, 1s=%zu, 3m=%zu\n", ctx.candle_500us.arr_size,
+		ctx.candle_500ms.arr_size, ctx.candle_1s.arr_size, ctx.candle_3m.arr_size);
 
-	stw_candle_ns_free(&candle_500us);
-	stw_candle_ns_free(&candle_500ms);
-	stw_candle_ns_free(&candle_1s);
-	stw_candle_ns_free(&candle_3m);
+	stw_candle_ns_free(&ctx.candle_500us);
+	stw_candle_ns_free(&ctx.candle_500ms);
+	stw_candle_ns_free(&ctx.candle_1s);
+	stw_candle_ns_free(&ctx.candle_3m);
 	return 0;
 }
 
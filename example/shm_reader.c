@@ -0,0 +1,65 @@
+/* Reader side of the shared-memory publisher.
+ *
+ *   terminal 1:  ./build/bin/wsreplay -f tests/sample.log --shm /stw-replay --shm-readers 1
+ *   terminal 2:  ./build/bin/shm_reader /stw-replay
+ *
+ * Each strategy process attaches the same way; the publisher reads and parses
+ * the log once for all of them.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "stw/replay.h"
+#include "stw/replay_shm.h"
+
+typedef struct {
+	uint64_t frames;
+	uint64_t bytes;
+} reader_stats_t;
+
+static void
+on_frame(void *user, const char *json, size_t len)
+{
+	reader_stats_t *st = (reader_stats_t *)user;
+	(void)json;
+	st->frames++;
+	st->bytes += len;
+}
+
+int
+main(int argc, char **argv)
+{
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s <shm name>\n", argv[0]);
+		return 1;
+	}
+
+	/* The publisher may not have created the ring yet; retry for ~10s */
+	stw_replay_shm_reader_t *rd = NULL;
+	for (int i = 0; i < 10000 && !rd; i++) {
+		rd = stw_replay_shm_reader_open(argv[1]);
+		if (!rd) {
+			struct timespec rq = {0, 1000000};
+			nanosleep(&rq, NULL);
+		}
+	}
+	if (!rd) {
+		fprintf(stderr, "no ring named '%s'\n", argv[1]);
+		return 1;
+	}
+
+	reader_stats_t st = {0};
+	int            rc = stw_replay_shm_run(rd, on_frame, &st);
+	fprintf(
+	    stderr,
+	    "frames=%llu bytes=%llu lost=%llu%s\n",
+	    (unsigned long long)st.frames,
+	    (unsigned long long)st.bytes,
+	    (unsigned long long)stw_replay_shm_lost(rd),
+	    stw_replay_shm_orphaned(rd) ? " (publisher died)" : ""
+	);
+	stw_replay_shm_reader_close(rd);
+	return rc;
+}
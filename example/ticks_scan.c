@@ -0,0 +1,73 @@
+/* Scan a columnar tick store without touching JSON.
+ *
+ *   ./build/bin/wsreplay -f day.log --export-ticks day.ticks
+ *   ./build/bin/ticks_scan day.ticks NIFTY
+ *
+ * Prints count / VWAP / min / max price for one instrument. Only the inst,
+ * price and qty columns are paged in; the loop is branch-light so the
+ * compiler can vectorise it.
+ */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "stw/replay_ticks.h"
+
+int
+main(int argc, char **argv)
+{
+	if (argc < 3) {
+		fprintf(stderr, "Usage: %s <ticks file> <instrument> [from_ns to_ns]\n", argv[0]);
+		return 1;
+	}
+	stw_ticks_t *T = stw_ticks_open(argv[1]);
+	if (!T) {
+		fprintf(stderr, "cannot open tick store '%s'\n", argv[1]);
+		return 1;
+	}
+	const stw_ticks_cols_t *c  = stw_ticks_cols(T);
+	int64_t                 id = stw_ticks_symbol_id(T, argv[2]);
+	if (id < 0) {
+		fprintf(stderr, "no instrument '%s' (%u in store)\n", argv[2], c->n_symbols);
+		stw_ticks_close(T);
+		return 1;
+	}
+
+	uint64_t lo = 0, hi = c->rows;
+	if (argc >= 5) {
+		stw_ticks_find_rows(T, strtoull(argv[3], NULL, 10), strtoull(argv[4], NULL, 10), &lo, &hi);
+	}
+
+	const uint32_t *inst  = __builtin_assume_aligned(c->inst, STW_TICKS_ALIGN);
+	const double   *price = __builtin_assume_aligned(c->price, STW_TICKS_ALIGN);
+	const int64_t  *qty   = __builtin_assume_aligned(c->qty, STW_TICKS_ALIGN);
+
+	uint64_t n = 0;
+	double   pv = 0.0, v = 0.0, mn = 1e300, mx = -1e300;
+	for (uint64_t i = lo; i < hi; i++) {
+		double m = (inst[i] == (uint32_t)id) ? 1.0 : 0.0;
+		double q = (double)qty[i] * m;
+		n += (uint64_t)m;
+		pv += price[i] * q;
+		v += q;
+		if (m != 0.0) {
+			mn = price[i] < mn ? price[i] : mn;
+			mx = price[i] > mx ? price[i] : mx;
+		}
+	}
+
+	printf(
+	    "%s: ticks=%" PRIu64 " vwap=%.4f min=%.2f max=%.2f (rows %" PRIu64 "..%" PRIu64 ")\n",
+	    argv[2],
+	    n,
+	    v > 0 ? pv / v : 0.0,
+	    n ? mn : 0.0,
+	    n ? mx : 0.0,
+	    lo,
+	    hi
+	);
+	stw_ticks_close(T);
+	return 0;
+}
@@ -97,10 +97,73 @@ extern "C" {
  * - **Looping**: Restart log on EOF.
  * - **Filtering**: Only replay lines that contain a substring (e.g., symbol).
  * - **Hard stop**: Stop after N frames.
+ * - **Checkpoint/resume**: Snapshot the replay position and continue from it
+ *   later with a single seek (see `stw_replay_checkpoint_t`).
+ * - **Realtime mode**: Pin the delivery thread, SCHED_FIFO, mlockall, pre-fault
+ *   and warm up before the first deadline (see `stw_replay_rt_opts_t`).
  * - **Compatibility shim**: Wraps to call your `cb_receive(wsi,user,in,len)`
  *   signature unchanged.
  */
 
+/**
+ * Replay position snapshot.
+ * - Obtain with `stw_replay_checkpoint()` (safe to call from inside the callback),
+ *   persist with `stw_replay_checkpoint_save()`, and pass back via
+ *   `stw_replay_opts_t.resume` to continue exactly after the last delivered frame.
+ */
+typedef struct stw_replay_checkpoint {
+    uint64_t offset;    /**< Byte offset of the next unread line in the log */
+    uint64_t last_ns;   /**< Log timestamp of the last delivered frame */
+    uint64_t first_ns;  /**< Epoch of the current pass (start offset is measured from it) */
+    uint64_t delivered; /**< Frames delivered so far in this run, across loop passes */
+    uint64_t loop_iter; /**< Completed passes over the file (with `loop`) */
+} stw_replay_checkpoint_t;
+
+/**
+ * Realtime delivery settings, applied to the thread that calls `stw_replay_run*()`
+ * just before the first deadline. Affinity and scheduling policy are restored
+ * when the run returns; locked memory stays locked.
+ */
+typedef struct stw_replay_rt_opts {
+    bool     enable;         /**< Apply the settings below. Default = false */
+    bool     pin;            /**< Pin the delivery thread to `cpu`. Default = false (affinity left alone) */
+    int      cpu;            /**< Core to pin to when `pin` is set. Default = 0 */
+    int      fifo_priority;  /**< SCHED_FIFO priority (1..99); 0 = keep the current policy */
+    bool     lock_memory;    /**< mlockall() current and future pages */
+    size_t   prefault_bytes; /**< Pre-touch this much line buffer and stack. 0 = 64 KiB */
+    uint32_t warmup_frames;  /**< Read and parse this many frames before the first deadline. 0 = 64 */
+    uint32_t spin_us;        /**< Busy-wait the last N microseconds before each deadline. 0 = sleep only */
+} stw_replay_rt_opts_t;
+
+/** Outcome of one realtime setting */
+typedef enum stw_replay_rt_status {
+    STW_RT_OFF = 0,     /**< Not requested */
+    STW_RT_OK,          /**< In effect */
+    STW_RT_FAILED,      /**< The call failed; see the matching `*_errno` */
+    STW_RT_UNSUPPORTED, /**< Not available on this platform */
+} stw_replay_rt_status_t;
+
+/** What `stw_replay_rt_opts_t` actually achieved (see `stw_replay_rt_report()`) */
+typedef struct stw_replay_rt_report {
+    stw_replay_rt_status_t pin, fifo, mlock, prefault, warmup;
+    int      pin_errno, fifo_errno, mlock_errno;
+    size_t   prefault_bytes; /**< Bytes pre-touched */
+    uint32_t warmup_frames;  /**< Frames parsed during warm-up (fewer if the log is short) */
+} stw_replay_rt_report_t;
+
+/**
+ * Read-ahead for scanning the log from slow (cold / network) storage.
+ * - Keeps `queue_depth` aligned reads of `block_size` bytes in flight ahead of
+ *   the parser, through io_uring when the kernel allows it and otherwise a
+ *   reader thread. Not used for index-driven replays, which read single lines.
+ */
+typedef struct stw_replay_io_opts {
+    bool     async;       /**< Enable read-ahead. Default = false (stdio) */
+    uint32_t queue_depth; /**< Reads in flight. 0 = 4 */
+    uint32_t block_size;  /**< Bytes per read, rounded up to 4 KiB. 0 = 1 MiB */
+    bool     no_uring;    /**< Use the reader-thread fallback even where io_uring works */
+} stw_replay_io_opts_t;
+
 /** Callback type: invoked for each replayed JSON frame */
 typedef void (*stw_replay_msg_cb)(void* user, const char* json, size_t len);
 
@@ -112,8 +175,16 @@ typedef struct stw_replay_opts {
     bool        loop;          /**< Loop replay when reaching end-of-file. Default = false */
     bool        no_sleep;      /**< If true, disables nanosleep; replay as fast as possible. Default = false */
     const char* filter_substr; /**< Only replay lines containing this substring (e.g. instrument symbol). Default = NULL */
-    uint64_t    hard_stop_count; /**< Stop after N messages. 0 = unlimited. Default = 0 */
+    uint64_t    hard_stop_count; /**< Stop each run after N messages (a resumed run counts from the checkpoint). 0 = unlimited. Default = 0 */
     bool        verbose;       /**< If true, print debug info for each frame. Default = false */
+    const stw_replay_checkpoint_t* resume; /**< Continue from this position instead of the file start. Default = NULL */
+    const char* checkpoint_file;  /**< Save a checkpoint here periodically and when the run ends. Default = NULL */
+    uint64_t    checkpoint_every; /**< Save every N delivered frames (0 = only at the end). Default = 0 */
+    const char* instruments;      /**< Comma-separated instrument names; only frames whose instrument_key value is one of them are replayed. Default = NULL (all) */
+    const char* instrument_key;   /**< JSON key holding the instrument. Default = "symbol" */
+    const char* index_file;       /**< Sidecar index (stw/replay_index.h); with instruments only their lines are read. Default = NULL */
+    stw_replay_rt_opts_t realtime; /**< Opt-in realtime delivery thread settings. Default = off */
+    stw_replay_io_opts_t io;       /**< Read-ahead for cold storage. Default = off */
 } stw_replay_opts_t;
 
 /** Parsed log frame (minimal fields we need) */
@@ -123,6 +194,9 @@ typedef struct stw_log_frame {
     size_t   json_len; /**< Length of JSON text */
 } stw_log_frame_t;
 
+/** Frame callback type: like `stw_replay_msg_cb` but also carries the log timestamp */
+typedef void (*stw_replay_frame_cb)(void* user, const stw_log_frame_t* frame);
+
 /** Opaque replay state */
 typedef struct stw_replay stw_replay_t;
 
@@ -134,18 +208,72 @@ stw_replay_t* stw_replay_create(const stw_replay_opts_t* opts);
 
 /**
  * Destroy a replay session.
+ * - A run still in progress is ended first, as by `stw_replay_end`.
  */
 void          stw_replay_destroy(stw_replay_t* R);
 
+/**
+ * Snapshot the current replay position into `out`.
+ * - Inside the callback, the snapshot already counts the frame being delivered.
+ * - Returns 0 on success, non-zero on error.
+ */
+int stw_replay_checkpoint(const stw_replay_t* R, stw_replay_checkpoint_t* out);
+
+/**
+ * Persist / restore a checkpoint as a one-line text file.
+ * - Save writes and fsyncs `<path>.tmp`, then renames it over `path`, so a process
+ *   crash or power loss leaves either the old or the new checkpoint, never a torn one.
+ * - Return 0 on success, non-zero on error (errno is set).
+ */
+int stw_replay_checkpoint_save(const char* path, const stw_replay_checkpoint_t* cp);
+int stw_replay_checkpoint_load(const char* path, stw_replay_checkpoint_t* out);
+
+/**
+ * Report which realtime settings took effect in the last run.
+ * - All fields are STW_RT_OFF before the first run or without `realtime.enable`.
+ * - Returns 0 on success, non-zero on error.
+ */
+int stw_replay_rt_report(const stw_replay_t* R, stw_replay_rt_report_t* out);
+
 /**
  * Run replay loop.
  * - Blocks until EOF (or hard stop count) reached.
  * - Calls `cb(user,json,len)` for each WS frame.
  * - Honors options: speed, no_sleep, loop, filter.
+ * - Each call is a new run from the file start with fresh counts; only the
+ *   first run of a session created with `resume` continues from it.
  * - Returns 0 on success, non-zero on error.
  */
 int stw_replay_run(stw_replay_t* R, stw_replay_msg_cb cb, void* user);
 
+/**
+ * Run replay loop, delivering whole frames.
+ * - Same semantics as `stw_replay_run`, but `cb(user,frame)` also sees `frame->ns`.
+ * - `frame->json` is only valid for the duration of the callback.
+ */
+int stw_replay_run_frames(stw_replay_t* R, stw_replay_frame_cb cb, void* user);
+
+/**
+ * Pull the next frame instead of registering a callback.
+ * - Paces, filters, loops, counts and checkpoints exactly like
+ *   `stw_replay_run_frames`, which is just a loop over this call.
+ * - `out->json` points into an internal buffer, valid until the next call.
+ * - Returns 1 with a frame, 0 when the replay is over (EOF without `loop`, or
+ *   the hard stop count), -1 on a read error or a NULL argument. A read error
+ *   ends the run; the saved checkpoint points after the last delivered frame.
+ */
+int stw_replay_next(stw_replay_t* R, stw_log_frame_t* out);
+
+/**
+ * End the current pull-style run, early or after `stw_replay_next` returned 0.
+ * - Restores the realtime thread settings and saves the final checkpoint, like
+ *   the end of `stw_replay_run`; call it on the thread that pulled the frames.
+ * - The next `stw_replay_next` starts a new run from the file start.
+ * - `stw_replay_destroy` ends a run still in progress itself.
+ * - Returns 0, or -1 if `R` is NULL.
+ */
+int stw_replay_end(stw_replay_t* R);
+
 /**
  * Convenience: create, run, and destroy in one call.
  * - Safer for most use cases.
@@ -0,0 +1,148 @@
+#ifndef STW_REPLAY_HPP
+#define STW_REPLAY_HPP
+
+#include "stw/replay.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// clang-format off
+
+/**
+ * stw-ws-replay — header-only C++ layer (C++17)
+ * =============================================
+ *
+ * The C API delivers frames through a function pointer plus `void* user`, so
+ * every frame pays an indirect call the compiler cannot see through. Here the
+ * handler is a template parameter: the replay loop below pulls frames with
+ * `stw_replay_next()` (same parser, pacing, filters, loop and checkpoints) and
+ * calls the handler directly, so a lambda body is inlined into the loop.
+ *
+ *   stw_replay_opts_t opt = {};
+ *   opt.logfile  = "day.log";
+ *   opt.no_sleep = true;
+ *
+ *   double last = 0;
+ *   stw::replay r(opt, [&](std::string_view json) { last = parse_ltp(json); });
+ *   r.run();
+ *
+ * - Handlers take `std::string_view` (the JSON) or `const stw::frame&`
+ *   (JSON plus log timestamp). The view is valid only during the call.
+ * - `stw::session` owns one `stw_replay_t` (RAII, move-only); construction
+ *   throws `std::runtime_error` when the log cannot be opened.
+ */
+
+namespace stw {
+
+/** One replayed WS frame */
+struct frame {
+    std::uint64_t    ns;   /**< Log timestamp in nanoseconds */
+    std::string_view json; /**< JSON text, valid until the next frame */
+};
+
+/** Owning handle for a C replay session */
+class session {
+public:
+    explicit session(const stw_replay_opts_t& opts) : R_(stw_replay_create(&opts))
+    {
+        if (!R_) throw std::runtime_error("stw::session: cannot open replay log");
+    }
+    ~session() { stw_replay_destroy(R_); }
+
+    session(session&& o) noexcept : R_(std::exchange(o.R_, nullptr)) {}
+    session& operator=(session&& o) noexcept
+    {
+        if (this != &o) {
+            stw_replay_destroy(R_);
+            R_ = std::exchange(o.R_, nullptr);
+        }
+        return *this;
+    }
+    session(const session&)            = delete;
+    session& operator=(const session&) = delete;
+
+    /** Pull one frame; false when the replay is over. Throws on read errors. */
+    bool next(frame& out)
+    {
+        stw_log_frame_t f;
+        int rc = stw_replay_next(R_, &f);
+        if (rc < 0) throw std::runtime_error("stw::session: replay failed");
+        if (rc == 0) return false;
+        out.ns   = f.ns;
+        out.json = std::string_view(f.json, f.json_len);
+        return true;
+    }
+
+    /** End the current run early (see `stw_replay_end()`); the destructor does it too */
+    void end() noexcept { stw_replay_end(R_); }
+
+    stw_replay_checkpoint_t checkpoint() const
+    {
+        stw_replay_checkpoint_t cp{};
+        stw_replay_checkpoint(R_, &cp);
+        return cp;
+    }
+
+    stw_replay_t* get() const noexcept { return R_; }
+
+private:
+    stw_replay_t* R_;
+};
+
+/** Replay loop with an inlined per-frame handler */
+template <class Handler>
+class replay {
+    static_assert(std::is_invocable_v<Handler&, const frame&> ||
+                      std::is_invocable_v<Handler&, std::string_view>,
+                  "stw::replay handler must accept const stw::frame& or std::string_view");
+
+public:
+    explicit replay(const stw_replay_opts_t& opts, Handler h = Handler{})
+        : S_(opts), h_(std::move(h))
+    {
+    }
+
+    replay(replay&&) noexcept            = default;
+    replay& operator=(replay&&) noexcept = default;
+    replay(const replay&)                = delete;
+    replay& operator=(const replay&)     = delete;
+
+    /**
+     * Replay to the end (EOF without `loop`, or the hard stop count).
+     * - Returns 0 on success, non-zero on error, like `stw_replay_run()`.
+     * - Each call is a new run from the file start with fresh counts, so
+     *   `hard_stop_count` applies per call, as with `stw_replay_run()`.
+     * - If the handler throws, the run is ended when the session is destroyed.
+     */
+    int run()
+    {
+        stw_log_frame_t f;
+        int rc;
+        while ((rc = stw_replay_next(S_.get(), &f)) == 1) {
+            if constexpr (std::is_invocable_v<Handler&, const frame&>)
+                h_(frame{f.ns, std::string_view(f.json, f.json_len)});
+            else
+                h_(std::string_view(f.json, f.json_len));
+        }
+        stw_replay_end(S_.get());
+        return rc < 0 ? rc : 0;
+    }
+
+    Handler&       handler() noexcept { return h_; }
+    session&       get_session() noexcept { return S_; }
+    const session& get_session() const noexcept { return S_; }
+
+private:
+    session S_;
+    Handler h_;
+};
+
+template <class Handler>
+replay(const stw_replay_opts_t&, Handler) -> replay<Handler>;
+
+} // namespace stw
+
+#endif /* STW_REPLAY_HPP */
@@ -0,0 +1,48 @@
+#ifndef STW_REPLAY_INDEX_H
+#define STW_REPLAY_INDEX_H
+
+#include "stw/replay.h"
+
+// clang-format off
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * stw-ws-replay — per-instrument sidecar index
+ * ============================================
+ *
+ * A filtered replay normally reads and scans every line of the log. The
+ * sidecar index, built once per log, maps each instrument to the byte offset
+ * and length of every WS line that carries it:
+ *
+ *   day.log ──► stw_replay_index_build() ──► day.log.idx
+ *                                              │ instrument → [(offset,len), ...]
+ *                                              ▼
+ *   opts.index_file + opts.instruments ──► merge exactly those lists by offset
+ *                                            ──► read only those lines
+ *
+ * - `instruments` is a comma-separated list of exact names ("NIFTY,TCS" does
+ *   not pick "BANKNIFTY"); the lists are merged on the fly so frames still
+ *   come out in file order. Names missing from the index are reported.
+ * - `filter_substr` still matches the raw line, on top of the selection.
+ * - The index records the log's size and mtime and the instrument key it was
+ *   built on; a stale index, or one built on another key than
+ *   `opts.instrument_key`, is ignored with a warning and the replay falls
+ *   back to a full scan (which selects the same frames, only slower).
+ * - WS lines without the instrument key are not indexed.
+ */
+
+/**
+ * Build the sidecar index for `logfile`.
+ * - `index_path` NULL = "<logfile>.idx"; `inst_key` NULL = "symbol".
+ * - Returns the number of indexed lines, or -1 on error.
+ */
+int64_t stw_replay_index_build(const char* logfile, const char* index_path, const char* inst_key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STW_REPLAY_INDEX_H */
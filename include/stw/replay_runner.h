@@ -0,0 +1,90 @@
+#ifndef STW_REPLAY_RUNNER_H
+#define STW_REPLAY_RUNNER_H
+
+#include "stw/replay.h"
+
+// clang-format off
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * stw-ws-replay — parallel multi-session runner
+ * =============================================
+ *
+ * Replays many independent logs (e.g. one per trading day) in one process,
+ * spread over a work-stealing thread pool. Each session gets its own replay
+ * handle and its own consumer context built by a user factory, so nothing is
+ * shared between sessions unless the factory shares it.
+ *
+ *   logfiles[] ──► sorted largest-first ──► per-worker deques
+ *                                               │  idle workers steal
+ *                                               ▼
+ *                 create(ctx) ─► stw_replay_run(cb, ctx) ─► destroy(ctx)
+ *                                               │
+ *                                               ▼
+ *                                 stw_replay_session_t results[i]
+ *
+ * Notes:
+ * ------
+ * - `base->logfile` is replaced per session; `resume`, `checkpoint_file` and
+ *   `index_file` are ignored (they name a single position / file), and so is
+ *   `realtime` (pinning every worker to one core would serialise them).
+ * - `loop` is forced off: every session replays its file once, so the
+ *   runner always returns.
+ * - Callbacks run on worker threads; a context is only ever touched by the
+ *   worker running its session.
+ * - On Windows the sessions run sequentially on the calling thread.
+ */
+
+/** Per-session outcome, filled in by the runner */
+typedef struct stw_replay_session {
+    size_t      index;     /**< Position in `logfiles` */
+    const char* logfile;   /**< Log replayed by this session */
+    int         rc;        /**< Replay result; -1 if the session could not start */
+    uint64_t    delivered; /**< Frames delivered to the callback */
+    uint64_t    start_ns;  /**< Start time relative to the runner start */
+    uint64_t    wall_ns;   /**< Wall time from the `create` callback to the end of the replay (excludes `destroy`, which already sees it) */
+    unsigned    worker;    /**< Worker thread that ran it */
+} stw_replay_session_t;
+
+/**
+ * Factory: build the consumer context for one session.
+ * - Set `*cb` (required) and `*ctx` (passed as `user` to the callback).
+ * - Return 0 to run the session, non-zero to skip it (rc = -1).
+ */
+typedef int (*stw_replay_ctx_create_fn)(void* factory_user, const stw_replay_session_t* s, stw_replay_msg_cb* cb, void** ctx);
+
+/**
+ * Teardown: called once the session finished; `s` already holds its result,
+ * so this is the place to harvest per-session output. Optional.
+ */
+typedef void (*stw_replay_ctx_destroy_fn)(void* factory_user, const stw_replay_session_t* s, void* ctx);
+
+/** Runner options */
+typedef struct stw_replay_runner_opts {
+    const stw_replay_opts_t*  base;         /**< Options shared by every session (required) */
+    const char* const*        logfiles;     /**< Logs to replay, one session each (required) */
+    size_t                    n_logfiles;   /**< Number of entries in `logfiles` */
+    unsigned                  threads;      /**< Worker threads. 0 = online CPUs. Default = 0 */
+    stw_replay_ctx_create_fn  create;       /**< Context factory (required) */
+    stw_replay_ctx_destroy_fn destroy;      /**< Context teardown. Default = NULL */
+    void*                     factory_user; /**< Passed to `create` / `destroy` */
+} stw_replay_runner_opts_t;
+
+/**
+ * Run every session and block until all finished.
+ * - `results` must hold `n_logfiles` entries; entry i describes `logfiles[i]`.
+ * - The calling thread works as well; if some workers fail to start, the
+ *   others steal their share.
+ * - Returns the number of failed sessions (0 = all succeeded), or -1 on bad
+ *   arguments.
+ */
+int stw_replay_runner_run(const stw_replay_runner_opts_t* ro, stw_replay_session_t* results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STW_REPLAY_RUNNER_H */
@@ -0,0 +1,120 @@
+#ifndef STW_REPLAY_SHM_H
+#define STW_REPLAY_SHM_H
+
+#include "stw/replay.h"
+
+// clang-format off
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * stw-ws-replay — shared-memory fan-out
+ * =====================================
+ *
+ * One publisher replays a log once into a POSIX shared-memory ring; any
+ * number of reader processes attach to the ring by name and consume the same
+ * frames, so N strategy processes no longer each read and parse the file.
+ *
+ *   ┌──────────────┐     ┌──────────────────────────┐     ┌──────────────┐
+ *   │ wsreplay     │ --> │ /dev/shm/<name>          │ --> │ reader proc  │
+ *   │ --shm <name> │     │ seq-numbered slot ring   │ --> │ reader proc  │
+ *   │ (1 writer)   │     │ + shared replay clock    │ --> │ ...          │
+ *   └──────────────┘     └──────────────────────────┘     └──────────────┘
+ *
+ * - Single writer, many readers, no locks: each slot carries the sequence
+ *   number of the frame it holds; readers validate it before and after the
+ *   copy (seqlock), so a reader never blocks the writer.
+ * - Readers that fall more than `slot_count` frames behind skip ahead to the
+ *   oldest retained frame; `stw_replay_shm_lost()` reports how many they missed.
+ * - The ring header records the monotonic instant and log timestamp of the
+ *   first frame of the current pass (re-published when `loop` starts a new
+ *   pass), so every process derives the same replay clock from
+ *   `stw_replay_shm_clock_ns()`.
+ * - The header records the publisher's pid. An idle reader checks it every
+ *   100 ms, so a publisher that was killed (e.g. a `--loop` run stopped with
+ *   Ctrl-C) ends the readers instead of leaving them spinning. The check
+ *   needs readers in the publisher's PID namespace.
+ * - Not available on Windows (calls fail with NULL / -1).
+ *
+ * Typical Usage (reader process):
+ * -------------------------------
+ * ```c
+ * stw_replay_shm_reader_t* rd = stw_replay_shm_reader_open("/stw-replay");
+ * stw_replay_shm_run(rd, my_cb, &my_ctx); // returns when the publisher is done
+ * stw_replay_shm_reader_close(rd);
+ * ```
+ */
+
+/** Publisher options */
+typedef struct stw_replay_shm_opts {
+    const char* name;         /**< POSIX shm object name, e.g. "/stw-replay" (required) */
+    uint32_t    slot_count;   /**< Ring capacity in frames, rounded up to a power of two. Default = 16384 */
+    uint32_t    slot_size;    /**< Max JSON bytes per frame; larger frames are dropped and counted. Default = 2048 */
+    uint32_t    wait_readers; /**< Hold the first frame until this many readers attached. Default = 0 */
+} stw_replay_shm_opts_t;
+
+/**
+ * Replay `opts->logfile` once into the shared-memory ring `shm->name`.
+ * - Recreates the segment (any stale one with the same name is unlinked).
+ * - Honors every replay option (speed, no_sleep, filter, loop, ...).
+ * - Unlinks the segment when done; readers already attached keep their mapping
+ *   and drain the remaining frames.
+ * - Returns 0 on success, non-zero on error.
+ */
+int stw_replay_shm_publish(const stw_replay_opts_t* opts, const stw_replay_shm_opts_t* shm);
+
+/** Opaque reader handle */
+typedef struct stw_replay_shm_reader stw_replay_shm_reader_t;
+
+/**
+ * Attach to a ring by name.
+ * - Returns NULL if the segment does not exist yet or is not initialised
+ *   (errno = ENOENT / EAGAIN); callers typically retry.
+ * - Starts at the oldest frame still held in the ring.
+ */
+stw_replay_shm_reader_t* stw_replay_shm_reader_open(const char* name);
+
+/**
+ * Detach from the ring.
+ */
+void stw_replay_shm_reader_close(stw_replay_shm_reader_t* rd);
+
+/**
+ * Non-blocking read of the next frame.
+ * - Returns 1 and fills `out` (valid until the next call), 0 if nothing new
+ *   yet, or -1 once the publisher finished or died and every frame it
+ *   published was consumed (`stw_replay_shm_orphaned()` tells which).
+ */
+int stw_replay_shm_poll(stw_replay_shm_reader_t* rd, stw_log_frame_t* out);
+
+/**
+ * Busy-poll the ring and call `cb(user,json,len)` for every frame.
+ * - Returns 0 when the publisher is done, non-zero on error or when the
+ *   publisher died before finishing.
+ */
+int stw_replay_shm_run(stw_replay_shm_reader_t* rd, stw_replay_msg_cb cb, void* user);
+
+/**
+ * Shared replay clock: the log timestamp (ns) the publisher is at right now,
+ * extrapolated from the current pass's epoch and the replay speed.
+ * - Returns 0 before the first frame was published.
+ */
+uint64_t stw_replay_shm_clock_ns(const stw_replay_shm_reader_t* rd);
+
+/**
+ * Number of frames this reader missed because the writer lapped it.
+ */
+uint64_t stw_replay_shm_lost(const stw_replay_shm_reader_t* rd);
+
+/**
+ * True once the reader found the publisher gone without finishing the replay.
+ */
+bool stw_replay_shm_orphaned(const stw_replay_shm_reader_t* rd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STW_REPLAY_SHM_H */
@@ -0,0 +1,130 @@
+#ifndef STW_REPLAY_TICKS_H
+#define STW_REPLAY_TICKS_H
+
+#include "stw/replay.h"
+
+// clang-format off
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * stw-ws-replay — columnar tick store
+ * ===================================
+ *
+ * Decodes replayed frames once into an on-disk, mmap-able column store so
+ * research code can scan prices and timestamps without touching JSON again.
+ *
+ * File layout:
+ * ------------
+ *
+ *   ┌────────┬────────┬──────────┬──────────┬──────┬───────┬─────┬──────────┐
+ *   │ header │ blocks │ ts_ns[]  │ exch_ts[]│ inst │ price │ qty │ symbols  │
+ *   │        │ min/max│ uint64   │ uint64   │ u32  │ f64   │ i64 │ dict     │
+ *   └────────┴────────┴──────────┴──────────┴──────┴───────┴─────┴──────────┘
+ *
+ * - Every column starts on a `STW_TICKS_ALIGN` boundary, so a column is a plain
+ *   aligned array once mapped and only the columns a scan touches get paged in.
+ * - Rows are grouped in blocks of `block_rows`; each block records the min/max
+ *   `ts_ns` so time-range scans skip whole blocks (`stw_ticks_find_rows`).
+ * - Instruments are interned into ids; `stw_ticks_symbol()` maps them back.
+ * - Native byte order; a file written on one endianness is rejected on the other.
+ * - The key defaults are only guesses: `tests/sample.log` and the demos carry
+ *   just `BCastTime` and `ltp`. Set `inst_key` / `qty_key` to the names your
+ *   feed uses, or every row gets an empty instrument and qty 0 (the export
+ *   warns when a key was never found).
+ *
+ * Typical Usage:
+ * --------------
+ * ```c
+ * stw_ticks_t* T = stw_ticks_open("day.ticks");
+ * const stw_ticks_cols_t* c = stw_ticks_cols(T);
+ * uint64_t lo, hi;
+ * stw_ticks_find_rows(T, from_ns, to_ns, &lo, &hi);
+ * double pv = 0, v = 0;
+ * for (uint64_t i = lo; i < hi; i++) { pv += c->price[i] * c->qty[i]; v += c->qty[i]; }
+ * stw_ticks_close(T);
+ * ```
+ */
+
+#define STW_TICKS_ALIGN 4096 /**< Column alignment in the file (and thus in the mapping) */
+
+/** Export options; every field is optional */
+typedef struct stw_ticks_export_opts {
+    const char* ts_key;     /**< JSON key of the exchange timestamp (seconds). Default = "BCastTime" */
+    const char* inst_key;   /**< JSON key of the instrument; set it for the real feed. Default = "symbol" */
+    const char* price_key;  /**< JSON key of the traded price. Default = "ltp" */
+    const char* qty_key;    /**< JSON key of the traded quantity; set it for the real feed. Default = "ltq" */
+    uint32_t    block_rows; /**< Rows per min/max block. Default = 8192 */
+} stw_ticks_export_opts_t;
+
+/**
+ * Replay `opts->logfile` (always without sleeping) and write a tick store to `out_path`.
+ * - Always covers the whole log: `loop`, `resume` and `checkpoint_file` are ignored.
+ * - Frames without a parseable price are skipped; missing fields become 0 / "".
+ * - Returns the number of rows written, or -1 on error.
+ */
+int64_t stw_ticks_export(const stw_replay_opts_t* opts, const char* out_path, const stw_ticks_export_opts_t* xo);
+
+/** Per-block summary used to skip data by time */
+typedef struct stw_ticks_block {
+    uint64_t min_ns;    /**< Smallest `ts_ns` in the block */
+    uint64_t max_ns;    /**< Largest `ts_ns` in the block */
+    uint64_t row_begin; /**< First row of the block */
+    uint64_t rows;      /**< Rows in the block */
+} stw_ticks_block_t;
+
+/** Column view of an open store; arrays hold `rows` entries each */
+typedef struct stw_ticks_cols {
+    uint64_t                 rows;
+    const uint64_t*          ts_ns;    /**< Log timestamp (ns), as scheduled by the replay engine */
+    const uint64_t*          exch_ts;  /**< Exchange timestamp from `ts_key` */
+    const uint32_t*          inst;     /**< Instrument id, see `stw_ticks_symbol()` */
+    const double*            price;
+    const int64_t*           qty;
+    uint64_t                 n_blocks;
+    const stw_ticks_block_t* blocks;
+    uint32_t                 n_symbols;
+} stw_ticks_cols_t;
+
+/** Opaque open store */
+typedef struct stw_ticks stw_ticks_t;
+
+/**
+ * Map a tick store read-only. Returns NULL on error.
+ */
+stw_ticks_t* stw_ticks_open(const char* path);
+
+/**
+ * Unmap and free.
+ */
+void stw_ticks_close(stw_ticks_t* T);
+
+/**
+ * Column pointers; valid until `stw_ticks_close()`.
+ */
+const stw_ticks_cols_t* stw_ticks_cols(const stw_ticks_t* T);
+
+/**
+ * Row range [*begin, *end) covering every row with from_ns <= ts_ns <= to_ns,
+ * found from the block summaries. Rows inside the range may still fall outside
+ * the window when the log is not perfectly time-ordered.
+ */
+void stw_ticks_find_rows(const stw_ticks_t* T, uint64_t from_ns, uint64_t to_ns, uint64_t* begin, uint64_t* end);
+
+/**
+ * Instrument name for an id (NUL-terminated), or NULL if out of range.
+ */
+const char* stw_ticks_symbol(const stw_ticks_t* T, uint32_t id);
+
+/**
+ * Instrument id for a name, or -1 if the store has no such instrument.
+ */
+int64_t stw_ticks_symbol_id(const stw_ticks_t* T, const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STW_REPLAY_TICKS_H */
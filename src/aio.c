@@ -0,0 +1,540 @@
+#if !defined(_WIN32)
+#define _GNU_SOURCE
+#endif
+
+#include "stw/replay.h"
+
+#include "internal_aio.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+
+stw_aio_t *
+stw_aio_open(int fd, uint64_t offset, const stw_replay_io_opts_t *io)
+{
+	(void)fd;
+	(void)offset;
+	(void)io;
+	return NULL; /* the caller keeps reading through stdio */
+}
+
+void
+stw_aio_close(stw_aio_t *A)
+{
+	(void)A;
+}
+
+ssize_t
+stw_aio_getline(stw_aio_t *A, char **line, size_t *cap)
+{
+	(void)A;
+	(void)line;
+	(void)cap;
+	return -1;
+}
+
+bool
+stw_aio_error(const stw_aio_t *A)
+{
+	(void)A;
+	return false;
+}
+
+const char *
+stw_aio_backend(const stw_aio_t *A)
+{
+	(void)A;
+	return "none";
+}
+
+#else
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+/*
+Pipeline:
+
+  file ─► slot[0] slot[1] ... slot[depth-1] ─► getline()
+          (one block each, consumed strictly in file order)
+
+  Block k lives in slot k % depth. When the reader moves past a block its
+  slot is refilled with block k + depth, so `depth` reads stay in flight
+  while the parser works. io_uring submits them straight to the kernel; the
+  fallback is one thread issuing preads into free slots.
+*/
+
+#define AIO_ALIGN         4096u
+#define AIO_DEFAULT_DEPTH 4u
+#define AIO_DEFAULT_BLOCK (1u << 20)
+
+enum { SLOT_FREE, SLOT_BUSY, SLOT_DONE };
+
+typedef struct {
+	char        *buf;
+	uint64_t     off; /* file offset of buf[0] */
+	size_t       want;
+	ssize_t      len; /* bytes read; -1 = error (errno in err) */
+	int          err;
+	int          state;
+	struct iovec iov;
+} aio_slot_t;
+
+#if defined(__linux__)
+typedef struct {
+	int                  fd;
+	unsigned            *sq_tail, *sq_mask, *sq_array;
+	unsigned            *cq_head, *cq_tail, *cq_mask;
+	struct io_uring_sqe *sqes;
+	struct io_uring_cqe *cqes;
+	void                *sq_map, *cq_map;
+	size_t               sq_len, cq_len, sqes_len;
+} uring_t;
+#endif
+
+struct stw_aio {
+	int         fd;
+	uint64_t    size;
+	size_t      block;
+	uint32_t    depth;
+	aio_slot_t *slots;
+	uint64_t    next_off; /* next block to submit */
+	uint64_t    n_submit; /* blocks submitted so far */
+	uint64_t    n_taken;  /* blocks handed to the line reader */
+	size_t      skip;     /* bytes of the first block before `offset` */
+
+	aio_slot_t *cur; /* block being split into lines, NULL before the first */
+	size_t      cur_pos;
+	bool        failed; /* a read failed; sticky, like ferror() */
+
+	bool uring;
+	char backend[96];
+#if defined(__linux__)
+	uring_t U;
+#endif
+
+	/* fallback reader thread */
+	pthread_t       th;
+	pthread_mutex_t mu;
+	pthread_cond_t  cv;
+	bool            th_started;
+	bool            stop;
+};
+
+static ssize_t
+pread_full(int fd, char *buf, size_t want, uint64_t off)
+{
+	size_t got = 0;
+	while (got < want) {
+		ssize_t n = pread(fd, buf + got, want - got, (off_t)(off + got));
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			return -1;
+		}
+		if (n == 0) break; /* truncated under us */
+		got += (size_t)n;
+	}
+	return (ssize_t)got;
+}
+
+/* Claim the slot for the next block; NULL once the whole file is submitted. */
+static aio_slot_t *
+claim_next(stw_aio_t *A)
+{
+	if (A->next_off >= A->size) return NULL;
+	aio_slot_t *S = &A->slots[A->n_submit % A->depth];
+	S->off        = A->next_off;
+	S->want       = A->size - S->off < A->block ? (size_t)(A->size - S->off) : A->block;
+	S->len        = 0;
+	S->err        = 0;
+	S->state      = SLOT_BUSY;
+	A->next_off  += S->want;
+	A->n_submit++;
+	return S;
+}
+
+/* ---------------------------------------------------------------- io_uring */
+
+#if defined(__linux__)
+
+/* Undo claim_next() for a block that never reached the kernel. */
+static void
+unclaim(stw_aio_t *A, aio_slot_t *S)
+{
+	S->state     = SLOT_FREE;
+	A->next_off -= S->want;
+	A->n_submit--;
+}
+
+static int
+uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+	return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static bool
+uring_init(uring_t *U, unsigned entries)
+{
+	struct io_uring_params p;
+	int                    e;
+	memset(&p, 0, sizeof(p));
+	memset(U, 0, sizeof(*U));
+	U->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+	if (U->fd < 0) return false;
+
+	U->sq_len   = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	U->cq_len   = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	U->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		if (U->cq_len > U->sq_len) U->sq_len = U->cq_len;
+		U->cq_len = 0;
+	}
+
+	int prot = PROT_READ | PROT_WRITE, fl = MAP_SHARED | MAP_POPULATE;
+	U->sq_map = mmap(NULL, U->sq_len, prot, fl, U->fd, IORING_OFF_SQ_RING);
+	if (U->sq_map == MAP_FAILED) goto fail;
+	U->cq_map = U->sq_map;
+	if (U->cq_len) {
+		U->cq_map = mmap(NULL, U->cq_len, prot, fl, U->fd, IORING_OFF_CQ_RING);
+		if (U->cq_map == MAP_FAILED) goto fail;
+	}
+	U->sqes = (struct io_uring_sqe *)mmap(NULL, U->sqes_len, prot, fl, U->fd, IORING_OFF_SQES);
+	if (U->sqes == MAP_FAILED) goto fail;
+
+	char *sq    = (char *)U->sq_map;
+	char *cq    = (char *)U->cq_map;
+	U->sq_tail  = (unsigned *)(sq + p.sq_off.tail);
+	U->sq_mask  = (unsigned *)(sq + p.sq_off.ring_mask);
+	U->sq_array = (unsigned *)(sq + p.sq_off.array);
+	U->cq_head  = (unsigned *)(cq + p.cq_off.head);
+	U->cq_tail  = (unsigned *)(cq + p.cq_off.tail);
+	U->cq_mask  = (unsigned *)(cq + p.cq_off.ring_mask);
+	U->cqes     = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+	return true;
+
+fail:
+	e = errno;
+	if (U->sq_map && U->sq_map != MAP_FAILED) munmap(U->sq_map, U->sq_len);
+	if (U->cq_len && U->cq_map && U->cq_map != MAP_FAILED) munmap(U->cq_map, U->cq_len);
+	close(U->fd);
+	memset(U, 0, sizeof(*U));
+	errno = e;
+	return false;
+}
+
+static void
+uring_free(uring_t *U)
+{
+	if (U->sqes) munmap(U->sqes, U->sqes_len);
+	if (U->cq_len) munmap(U->cq_map, U->cq_len);
+	if (U->sq_map) munmap(U->sq_map, U->sq_len);
+	close(U->fd);
+}
+
+static bool
+uring_submit(stw_aio_t *A, aio_slot_t *S)
+{
+	uring_t             *U    = &A->U;
+	unsigned             tail = *U->sq_tail;
+	unsigned             idx  = tail & *U->sq_mask;
+	struct io_uring_sqe *sqe  = &U->sqes[idx];
+
+	S->iov.iov_base = S->buf;
+	S->iov.iov_len  = S->want;
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode    = IORING_OP_READV; /* 5.1+, unlike IORING_OP_READ */
+	sqe->fd        = A->fd;
+	sqe->addr      = (uint64_t)(uintptr_t)&S->iov;
+	sqe->len       = 1;
+	sqe->off       = S->off;
+	sqe->user_data = (uint64_t)(S - A->slots);
+
+	U->sq_array[idx] = idx;
+	atomic_store_explicit((_Atomic unsigned *)U->sq_tail, tail + 1, memory_order_release);
+	while (uring_enter(U->fd, 1, 0, 0) < 0) {
+		if (errno == EINTR || errno == EAGAIN) continue;
+		/* The kernel did not take the SQE: retract it and free the slot, or
+		 * stw_aio_close() would wait for a completion that never comes. */
+		atomic_store_explicit((_Atomic unsigned *)U->sq_tail, tail, memory_order_release);
+		unclaim(A, S);
+		return false;
+	}
+	return true;
+}
+
+/* Reap completions until slot S is done. */
+static bool
+uring_wait(stw_aio_t *A, aio_slot_t *S)
+{
+	uring_t *U = &A->U;
+	while (S->state != SLOT_DONE) {
+		unsigned head = *U->cq_head;
+		unsigned tail =
+		    atomic_load_explicit((_Atomic unsigned *)U->cq_tail, memory_order_acquire);
+		if (head == tail) {
+			int rc = uring_enter(U->fd, 0, 1, IORING_ENTER_GETEVENTS);
+			if (rc < 0 && errno != EINTR) return false;
+			continue;
+		}
+		struct io_uring_cqe *cqe = &U->cqes[head & *U->cq_mask];
+		aio_slot_t          *D   = &A->slots[cqe->user_data];
+		if (cqe->res < 0) {
+			D->len = -1;
+			D->err = -cqe->res;
+		} else {
+			D->len = cqe->res;
+			if ((size_t)D->len < D->want) { /* short read: finish it synchronously */
+				ssize_t more = pread_full(
+				    A->fd,
+				    D->buf + D->len,
+				    D->want - (size_t)D->len,
+				    D->off + (uint64_t)D->len
+				);
+				if (more < 0) {
+					D->len = -1;
+					D->err = errno;
+				} else {
+					D->len += more;
+				}
+			}
+		}
+		D->state = SLOT_DONE;
+		atomic_store_explicit((_Atomic unsigned *)U->cq_head, head + 1, memory_order_release);
+	}
+	return true;
+}
+
+#endif /* __linux__ */
+
+/* ---------------------------------------------------------- reader thread */
+
+static void *
+reader_main(void *arg)
+{
+	stw_aio_t *A = (stw_aio_t *)arg;
+	pthread_mutex_lock(&A->mu);
+	for (;;) {
+		aio_slot_t *S = NULL;
+		while (!A->stop) {
+			if (A->next_off < A->size && A->slots[A->n_submit % A->depth].state == SLOT_FREE) {
+				S = claim_next(A);
+				break;
+			}
+			pthread_cond_wait(&A->cv, &A->mu);
+		}
+		if (A->stop) break;
+		pthread_mutex_unlock(&A->mu);
+
+		ssize_t n = pread_full(A->fd, S->buf, S->want, S->off);
+		int     e = errno;
+
+		pthread_mutex_lock(&A->mu);
+		S->len   = n;
+		S->err   = n < 0 ? e : 0;
+		S->state = SLOT_DONE;
+		pthread_cond_broadcast(&A->cv);
+	}
+	pthread_mutex_unlock(&A->mu);
+	return NULL;
+}
+
+/* ------------------------------------------------------------------ public */
+
+/* Hand the block after the current one to the line reader; 0 at end of file. */
+static int
+next_block(stw_aio_t *A)
+{
+	if (A->cur) { /* recycle the finished slot for a block further ahead */
+		if (A->uring) {
+#if defined(__linux__)
+			A->cur->state = SLOT_FREE;
+			aio_slot_t *S = claim_next(A);
+			if (S && !uring_submit(A, S)) return -1;
+#endif
+		} else {
+			pthread_mutex_lock(&A->mu);
+			A->cur->state = SLOT_FREE;
+			pthread_cond_broadcast(&A->cv);
+			pthread_mutex_unlock(&A->mu);
+		}
+		A->cur = NULL;
+	}
+
+	aio_slot_t *S = &A->slots[A->n_taken % A->depth];
+	if (A->uring) {
+#if defined(__linux__)
+		if (A->n_taken == A->n_submit) return 0;
+		if (!uring_wait(A, S)) return -1;
+#endif
+	} else {
+		pthread_mutex_lock(&A->mu);
+		while (S->state != SLOT_DONE && !(A->n_taken == A->n_submit && A->next_off >= A->size))
+			pthread_cond_wait(&A->cv, &A->mu);
+		bool eof = S->state != SLOT_DONE;
+		pthread_mutex_unlock(&A->mu);
+		if (eof) return 0;
+	}
+	if (S->len < 0) {
+		errno = S->err;
+		return -1;
+	}
+	A->cur     = S;
+	A->cur_pos = A->n_taken == 0 ? A->skip : 0;
+	A->n_taken++;
+	return 1;
+}
+
+stw_aio_t *
+stw_aio_open(int fd, uint64_t offset, const stw_replay_io_opts_t *io)
+{
+	struct stat st;
+	if (fstat(fd, &st) != 0) return NULL;
+
+	stw_aio_t *A = (stw_aio_t *)calloc(1, sizeof(*A));
+	if (!A) return NULL;
+	A->fd    = fd;
+	A->size  = (uint64_t)st.st_size;
+	A->depth = io->queue_depth ? io->queue_depth : AIO_DEFAULT_DEPTH;
+	A->block = io->block_size ? io->block_size : AIO_DEFAULT_BLOCK;
+	A->block = (A->block + AIO_ALIGN - 1) / AIO_ALIGN * AIO_ALIGN;
+	A->skip  = (size_t)(offset % AIO_ALIGN); /* start on an aligned boundary */
+	A->next_off = offset - A->skip;
+	A->slots    = (aio_slot_t *)calloc(A->depth, sizeof(*A->slots));
+	if (!A->slots) goto fail;
+	for (uint32_t i = 0; i < A->depth; i++) {
+		if (posix_memalign((void **)&A->slots[i].buf, AIO_ALIGN, A->block) != 0) goto fail;
+	}
+#if defined(POSIX_FADV_SEQUENTIAL)
+	posix_fadvise(fd, (off_t)A->next_off, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+	const char *why = "disabled";
+#if defined(__linux__)
+	if (!io->no_uring) {
+		A->uring = uring_init(&A->U, A->depth);
+		why      = A->uring ? NULL : strerror(errno);
+	}
+#else
+	why = "not on this platform";
+#endif
+	if (A->uring) {
+#if defined(__linux__)
+		snprintf(A->backend, sizeof(A->backend), "io_uring");
+		aio_slot_t *S;
+		while (A->n_submit < A->depth && (S = claim_next(A)))
+			if (!uring_submit(A, S)) goto fail;
+#endif
+		return A;
+	}
+
+	snprintf(A->backend, sizeof(A->backend), "thread (io_uring: %s)", why);
+	pthread_mutex_init(&A->mu, NULL);
+	pthread_cond_init(&A->cv, NULL);
+	if (pthread_create(&A->th, NULL, reader_main, A) != 0) goto fail;
+	A->th_started = true;
+	return A;
+
+fail:
+	fprintf(stderr, "replay: async reader setup failed: %s\n", strerror(errno));
+	stw_aio_close(A);
+	return NULL;
+}
+
+void
+stw_aio_close(stw_aio_t *A)
+{
+	if (!A) return;
+	if (A->th_started) {
+		pthread_mutex_lock(&A->mu);
+		A->stop = true;
+		pthread_cond_broadcast(&A->cv);
+		pthread_mutex_unlock(&A->mu);
+		pthread_join(A->th, NULL);
+		pthread_mutex_destroy(&A->mu);
+		pthread_cond_destroy(&A->cv);
+	}
+#if defined(__linux__)
+	if (A->uring) {
+		/* the kernel may still be writing into busy slots: drain before freeing */
+		for (uint32_t i = 0; i < A->depth; i++)
+			if (A->slots[i].state == SLOT_BUSY && !uring_wait(A, &A->slots[i])) break;
+		uring_free(&A->U);
+	}
+#endif
+	if (A->slots) {
+		for (uint32_t i = 0; i < A->depth; i++)
+			free(A->slots[i].buf);
+		free(A->slots);
+	}
+	free(A);
+}
+
+ssize_t
+stw_aio_getline(stw_aio_t *A, char **line, size_t *cap)
+{
+	size_t n = 0;
+	if (A->failed) return -1;
+	for (;;) {
+		if (!A->cur || A->cur_pos >= (size_t)A->cur->len) {
+			int rc = next_block(A);
+			if (rc < 0) {
+				fprintf(stderr, "replay: async read failed: %s\n", strerror(errno));
+				A->failed = true;
+				return -1;
+			}
+			if (rc == 0) {
+				if (n == 0) return -1;
+				break; /* last line without a newline */
+			}
+			continue;
+		}
+		const char *p     = A->cur->buf + A->cur_pos;
+		size_t      avail = (size_t)A->cur->len - A->cur_pos;
+		const char *nl    = (const char *)memchr(p, '\n', avail);
+		size_t      take  = nl ? (size_t)(nl - p) + 1 : avail;
+		if (n + take + 1 > *cap) {
+			size_t ncap = *cap ? *cap : 256;
+			while (ncap < n + take + 1)
+				ncap *= 2;
+			char *nb = (char *)realloc(*line, ncap);
+			if (!nb) {
+				A->failed = true;
+				return -1;
+			}
+			*line = nb;
+			*cap  = ncap;
+		}
+		memcpy(*line + n, p, take);
+		n          += take;
+		A->cur_pos += take;
+		if (nl) break;
+	}
+	(*line)[n] = '\0';
+	return (ssize_t)n;
+}
+
+bool
+stw_aio_error(const stw_aio_t *A)
+{
+	return A->failed;
+}
+
+const char *
+stw_aio_backend(const stw_aio_t *A)
+{
+	return A->backend;
+}
+
+#endif /* _WIN32 */
@@ -2,6 +2,8 @@
 #define _POSIX_C_SOURCE 199309L
 #endif
 
+#include "internal_clock.h"
+
 #include <stdint.h>
 #include <time.h>
 
@@ -22,9 +24,9 @@ static inline uint64_t
 now_ns_mono(void)
 {
 #if defined(_WIN32)
-	static LARGE_INTEGER freq = {0};
-	if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
-	LARGE_INTEGER ctr;
+	/* No cached static: sessions on several threads may call this concurrently */
+	LARGE_INTEGER freq, ctr;
+	QueryPerformanceFrequency(&freq);
 	QueryPerformanceCounter(&ctr);
 	return (uint64_t)((double)ctr.QuadPart / (double)freq.QuadPart * 1e9);
 #else
@@ -34,6 +36,13 @@ now_ns_mono(void)
 #endif
 }
 
+/* Exported to the other translation units through internal_clock.h */
+uint64_t
+stw_replay_now_ns(void)
+{
+	return now_ns_mono();
+}
+
 void
 stw_replay_sleep_until(uint64_t target_ns)
 {
@@ -55,3 +64,11 @@ stw_replay_sleep_until(uint64_t target_ns)
 #endif
 	}
 }
+
+void
+stw_replay_wait_until(uint64_t target_ns, uint64_t spin_ns)
+{
+	if (target_ns > spin_ns) stw_replay_sleep_until(target_ns - spin_ns);
+	while (now_ns_mono() < target_ns) {
+	}
+}
@@ -0,0 +1,488 @@
+#if !defined(_WIN32)
+#define _GNU_SOURCE
+#endif
+
+#include "stw/replay.h"
+#include "stw/replay_index.h"
+
+#include "internal_index.h"
+#include "internal_io.h"
+#include "internal_map.h"
+#include "internal_parser.h"
+#include "internal_strtab.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/*
+Index file shape:
+
+  [ idx_hdr ][ idx_key x n_keys (sorted by name) ][ idx_line x n_lines ][ names ][ inst_key ]
+
+Key k owns lines[first .. first+count), ascending by offset. `inst_key` is the
+JSON key the index was built on, NUL-terminated.
+*/
+
+#define IDX_MAGIC   0x3130584449575453ull /* "STWIDX01" little-endian */
+#define IDX_VERSION 2u
+
+struct idx_hdr {
+	uint64_t magic;
+	uint32_t version;
+	uint32_t n_keys;
+	uint64_t n_lines;
+	uint64_t log_size;
+	int64_t  log_mtime;
+	uint64_t off_keys;
+	uint64_t off_lines;
+	uint64_t off_names;
+	uint64_t names_len;
+	uint64_t off_inst_key;
+	uint64_t inst_key_len; /* without the NUL */
+	uint64_t file_len;
+};
+
+struct idx_key {
+	uint32_t name_off;
+	uint32_t reserved;
+	uint64_t first;
+	uint64_t count;
+};
+
+struct idx_line {
+	uint64_t offset;
+	uint32_t len;
+	uint32_t reserved;
+};
+
+static bool
+log_identity(const char *logfile, uint64_t *size, int64_t *mtime)
+{
+	struct stat st;
+	if (stat(logfile, &st) != 0) return false;
+	*size  = (uint64_t)st.st_size;
+	*mtime = (int64_t)st.st_mtime;
+	return true;
+}
+
+/* ------------------------------------------------------------------- build */
+
+typedef struct {
+	uint64_t offset;
+	uint32_t len;
+	uint32_t key;
+} raw_line_t;
+
+typedef struct {
+	const char *name;
+	uint32_t    id;
+} named_id_t;
+
+static int
+by_name(const void *a, const void *b)
+{
+	return strcmp(((const named_id_t *)a)->name, ((const named_id_t *)b)->name);
+}
+
+static bool
+write_index(
+    const char         *path,
+    const char         *inst_key,
+    const stw_strtab_t *keys,
+    const raw_line_t   *raw,
+    uint64_t            n,
+    uint64_t            log_size,
+    int64_t             log_mtime
+)
+{
+	bool             ok    = false;
+	named_id_t      *order = (named_id_t *)malloc(((size_t)keys->n + 1) * sizeof(*order));
+	uint64_t        *first = (uint64_t *)calloc((size_t)keys->n + 1, sizeof(*first));
+	struct idx_key  *K     = (struct idx_key *)calloc((size_t)keys->n + 1, sizeof(*K));
+	struct idx_line *L     = (struct idx_line *)malloc((size_t)(n ? n : 1) * sizeof(*L));
+	FILE            *fp    = NULL;
+	if (!order || !first || !K || !L) goto out;
+
+	/* keys by name, then a stable counting sort of lines into that key order */
+	for (uint32_t k = 0; k < keys->n; k++) {
+		order[k].name = stw_strtab_name(keys, k);
+		order[k].id   = k;
+	}
+	qsort(order, keys->n, sizeof(*order), by_name);
+
+	uint64_t *count = first; /* per original key id, reused as write cursor */
+	for (uint64_t i = 0; i < n; i++)
+		count[raw[i].key]++;
+	uint64_t acc = 0;
+	for (uint32_t r = 0; r < keys->n; r++) {
+		uint32_t k       = order[r].id;
+		K[r].name_off    = keys->off[k];
+		K[r].first       = acc;
+		K[r].count       = count[k];
+		acc             += count[k];
+		count[k]         = K[r].first;
+	}
+	for (uint64_t i = 0; i < n; i++) {
+		struct idx_line *dst = &L[count[raw[i].key]++];
+		dst->offset          = raw[i].offset;
+		dst->len             = raw[i].len;
+		dst->reserved        = 0;
+	}
+
+	struct idx_hdr H = {0};
+	H.magic          = IDX_MAGIC;
+	H.version        = IDX_VERSION;
+	H.n_keys         = keys->n;
+	H.n_lines        = n;
+	H.log_size       = log_size;
+	H.log_mtime      = log_mtime;
+	H.off_keys       = sizeof(H);
+	H.off_lines      = H.off_keys + (uint64_t)keys->n * sizeof(*K);
+	H.off_names      = H.off_lines + n * sizeof(*L);
+	H.names_len      = keys->names_len;
+	H.off_inst_key   = H.off_names + H.names_len;
+	H.inst_key_len   = strlen(inst_key);
+	H.file_len       = H.off_inst_key + H.inst_key_len + 1;
+
+	fp = fopen(path, "wb");
+	if (!fp) {
+		fprintf(stderr, "replay: fopen('%s') failed: %s\n", path, strerror(errno));
+		goto out;
+	}
+	ok = fwrite(&H, sizeof(H), 1, fp) == 1 &&
+	     fwrite(K, sizeof(*K), keys->n, fp) == keys->n &&
+	     fwrite(L, sizeof(*L), (size_t)n, fp) == (size_t)n &&
+	     fwrite(keys->names, 1, keys->names_len, fp) == keys->names_len &&
+	     fwrite(inst_key, 1, (size_t)H.inst_key_len + 1, fp) == H.inst_key_len + 1;
+	if (fclose(fp) != 0) ok = false;
+	if (!ok) {
+		fprintf(stderr, "replay: writing '%s' failed: %s\n", path, strerror(errno));
+		remove(path);
+	}
+
+out:
+	free(order);
+	free(first);
+	free(K);
+	free(L);
+	return ok;
+}
+
+int64_t
+stw_replay_index_build(const char *logfile, const char *index_path, const char *inst_key)
+{
+	if (!logfile) return -1;
+	if (!inst_key) inst_key = "symbol";
+
+	char *def_path = NULL;
+	if (!index_path) {
+		size_t n = strlen(logfile);
+		def_path = (char *)malloc(n + sizeof(".idx"));
+		if (!def_path) return -1;
+		memcpy(def_path, logfile, n);
+		memcpy(def_path + n, ".idx", sizeof(".idx"));
+		index_path = def_path;
+	}
+
+	uint64_t log_size  = 0;
+	int64_t  log_mtime = 0;
+	FILE    *fp        = fopen(logfile, "rb");
+	if (!fp || !log_identity(logfile, &log_size, &log_mtime)) {
+		fprintf(stderr, "replay: fopen('%s') failed: %s\n", logfile, strerror(errno));
+		if (fp) fclose(fp);
+		free(def_path);
+		return -1;
+	}
+
+	stw_strtab_t keys = {0};
+	raw_line_t  *raw  = NULL;
+	uint64_t     n = 0, cap = 0, pos = 0;
+	bool         ok   = true;
+	char        *line = NULL;
+	size_t       lcap = 0;
+	ssize_t      len;
+
+	while (ok && (len = getline(&line, &lcap, fp)) != -1) {
+		uint64_t        start = pos;
+		stw_log_frame_t f     = {0};
+		const char     *v     = NULL;
+		size_t          vn    = 0;
+		uint32_t        key   = 0;
+		pos += (uint64_t)len;
+
+		if (!_stw_parser_try_extract(line, NULL, &f)) continue;
+		if (!stw_json_find_scalar(f.json, f.json_len, inst_key, &v, &vn)) continue;
+		if (!stw_strtab_intern(&keys, v, vn, &key)) {
+			ok = false;
+			break;
+		}
+		if (n == cap) {
+			uint64_t    ncap = cap ? cap * 2 : 65536;
+			raw_line_t *nr   = (raw_line_t *)realloc(raw, (size_t)ncap * sizeof(*raw));
+			if (!nr) {
+				ok = false;
+				break;
+			}
+			raw = nr;
+			cap = ncap;
+		}
+		raw[n].offset = start;
+		raw[n].len    = (uint32_t)len;
+		raw[n].key    = key;
+		n++;
+	}
+	free(line);
+	fclose(fp);
+
+	ok = ok && write_index(index_path, inst_key, &keys, raw, n, log_size, log_mtime);
+
+	free(raw);
+	stw_strtab_free(&keys);
+	free(def_path);
+	return ok ? (int64_t)n : -1;
+}
+
+/* ---------------------------------------------------------- instrument list */
+
+static int
+by_str(const void *a, const void *b)
+{
+	return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+bool
+stw_inst_list_parse(stw_inst_list_t *L, const char *csv)
+{
+	memset(L, 0, sizeof(*L));
+	size_t len = strlen(csv), n = 1;
+	for (size_t i = 0; i < len; i++)
+		n += csv[i] == ',';
+	L->buf   = (char *)malloc(len + 1);
+	L->names = (const char **)malloc(n * sizeof(*L->names));
+	if (!L->buf || !L->names) {
+		stw_inst_list_free(L);
+		return false;
+	}
+	memcpy(L->buf, csv, len + 1);
+	for (char *tok = L->buf, *comma; tok; tok = comma) {
+		comma = strchr(tok, ',');
+		if (comma) *comma++ = '\0';
+		if (*tok) L->names[L->n++] = tok;
+	}
+	/* sorted and de-duplicated, so each name selects its list once */
+	qsort(L->names, L->n, sizeof(*L->names), by_str);
+	uint32_t u = 0;
+	for (uint32_t i = 0; i < L->n; i++)
+		if (u == 0 || strcmp(L->names[u - 1], L->names[i]) != 0) L->names[u++] = L->names[i];
+	L->n = u;
+	return true;
+}
+
+bool
+stw_inst_list_has(const stw_inst_list_t *L, const char *name, size_t len)
+{
+	uint32_t lo = 0, hi = L->n;
+	while (lo < hi) {
+		uint32_t    mid = lo + (hi - lo) / 2;
+		const char *m   = L->names[mid];
+		int         c   = strncmp(m, name, len);
+		if (c == 0) c = m[len] != '\0'; /* a longer list name sorts after `name` */
+		if (c == 0) return true;
+		if (c < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return false;
+}
+
+void
+stw_inst_list_free(stw_inst_list_t *L)
+{
+	free(L->buf);
+	free((void *)L->names);
+	memset(L, 0, sizeof(*L));
+}
+
+/* ---------------------------------------------------------------- selection */
+
+typedef struct {
+	uint64_t cur;
+	uint64_t end;
+	uint64_t first; /* rewind point */
+} sel_list_t;
+
+struct stw_index_sel {
+	void                  *base;
+	size_t                 len;
+	const struct idx_line *lines;
+	sel_list_t            *lists;
+	uint32_t               n_lists;
+	uint32_t              *heap; /* min-heap of list ids by current offset */
+	uint32_t               n_heap;
+};
+
+static inline uint64_t
+head_off(const stw_index_sel_t *S, uint32_t l)
+{
+	return S->lines[S->lists[l].cur].offset;
+}
+
+static void
+sift_down(stw_index_sel_t *S, uint32_t i)
+{
+	for (;;) {
+		uint32_t m = i, a = 2 * i + 1, b = a + 1;
+		if (a < S->n_heap && head_off(S, S->heap[a]) < head_off(S, S->heap[m])) m = a;
+		if (b < S->n_heap && head_off(S, S->heap[b]) < head_off(S, S->heap[m])) m = b;
+		if (m == i) return;
+		uint32_t t = S->heap[i];
+		S->heap[i] = S->heap[m];
+		S->heap[m] = t;
+		i          = m;
+	}
+}
+
+static void
+heapify(stw_index_sel_t *S)
+{
+	S->n_heap = 0;
+	for (uint32_t l = 0; l < S->n_lists; l++)
+		if (S->lists[l].cur < S->lists[l].end) S->heap[S->n_heap++] = l;
+	for (uint32_t i = S->n_heap / 2; i-- > 0;)
+		sift_down(S, i);
+}
+
+stw_index_sel_t *
+stw_index_select(
+    const char            *index_path,
+    const char            *logfile,
+    const char            *inst_key,
+    const stw_inst_list_t *insts
+)
+{
+	size_t len  = 0;
+	void  *base = stw_map_file(index_path, &len);
+	if (!base) {
+		fprintf(stderr, "replay: index '%s' unusable: %s\n", index_path, strerror(errno));
+		return NULL;
+	}
+
+	const struct idx_hdr *H = (const struct idx_hdr *)base;
+	uint64_t              log_size;
+	int64_t               log_mtime;
+	const char           *why = NULL;
+	if (len < sizeof(*H) || H->magic != IDX_MAGIC || H->version != IDX_VERSION ||
+	    H->file_len > len || H->off_keys > len ||
+	    (uint64_t)H->n_keys > (len - H->off_keys) / sizeof(struct idx_key) ||
+	    H->off_lines > len || H->n_lines > (len - H->off_lines) / sizeof(struct idx_line) ||
+	    H->off_names > len || H->names_len > len - H->off_names ||
+	    (H->names_len && ((const char *)base)[H->off_names + H->names_len - 1] != '\0') ||
+	    H->off_inst_key > len || H->inst_key_len >= len - H->off_inst_key ||
+	    ((const char *)base)[H->off_inst_key + H->inst_key_len] != '\0')
+		why = "not a valid index";
+	else if (strcmp((const char *)base + H->off_inst_key, inst_key) != 0)
+		why = "was built on a different instrument key";
+	else if (!log_identity(logfile, &log_size, &log_mtime))
+		why = "log not found";
+	else if (log_size != H->log_size || log_mtime != H->log_mtime)
+		why = "stale (log changed since it was built)";
+	if (why) {
+		fprintf(stderr, "replay: index '%s' %s; scanning the full log\n", index_path, why);
+		stw_unmap_file(base, len);
+		return NULL;
+	}
+
+	stw_index_sel_t *S = (stw_index_sel_t *)calloc(1, sizeof(*S));
+	if (!S) {
+		stw_unmap_file(base, len);
+		return NULL;
+	}
+	S->base  = base;
+	S->len   = len;
+	S->lines = (const struct idx_line *)((const char *)base + H->off_lines);
+	S->lists = (sel_list_t *)calloc(insts->n ? insts->n : 1, sizeof(*S->lists));
+	S->heap  = (uint32_t *)calloc(insts->n ? insts->n : 1, sizeof(*S->heap));
+	if (!S->lists || !S->heap) {
+		stw_index_sel_free(S);
+		return NULL;
+	}
+
+	const struct idx_key *K     = (const struct idx_key *)((const char *)base + H->off_keys);
+	const char           *names = (const char *)base + H->off_names;
+	for (uint32_t i = 0; i < insts->n; i++) {
+		/* keys are sorted by name: binary search for each requested instrument */
+		uint32_t lo = 0, hi = H->n_keys;
+		int      c  = 1;
+		while (lo < hi) {
+			uint32_t mid = lo + (hi - lo) / 2;
+			c            = K[mid].name_off < H->names_len
+			                   ? strcmp(names + K[mid].name_off, insts->names[i])
+			                   : 1;
+			if (c == 0) {
+				lo = mid;
+				break;
+			}
+			if (c < 0)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (c != 0) {
+			fprintf(stderr, "replay: instrument '%s' is not in the index\n", insts->names[i]);
+			continue;
+		}
+		const struct idx_key *k = &K[lo];
+		if (k->first > H->n_lines || k->count > H->n_lines - k->first) continue;
+		sel_list_t *L = &S->lists[S->n_lists++];
+		L->first      = k->first;
+		L->cur        = k->first;
+		L->end        = k->first + k->count;
+	}
+	heapify(S);
+	return S;
+}
+
+void
+stw_index_sel_free(stw_index_sel_t *S)
+{
+	if (!S) return;
+	stw_unmap_file(S->base, S->len);
+	free(S->lists);
+	free(S->heap);
+	free(S);
+}
+
+void
+stw_index_sel_seek(stw_index_sel_t *S, uint64_t offset)
+{
+	for (uint32_t l = 0; l < S->n_lists; l++) {
+		sel_list_t *L  = &S->lists[l];
+		uint64_t    lo = L->first, hi = L->end;
+		while (lo < hi) {
+			uint64_t mid = lo + (hi - lo) / 2;
+			if (S->lines[mid].offset < offset)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		L->cur = lo;
+	}
+	heapify(S);
+}
+
+bool
+stw_index_sel_next(stw_index_sel_t *S, uint64_t *offset, uint32_t *len)
+{
+	if (S->n_heap == 0) return false;
+	uint32_t               l  = S->heap[0];
+	const struct idx_line *ln = &S->lines[S->lists[l].cur++];
+	*offset                   = ln->offset;
+	*len                      = ln->len;
+	if (S->lists[l].cur == S->lists[l].end) S->heap[0] = S->heap[--S->n_heap];
+	sift_down(S, 0);
+	return true;
+}
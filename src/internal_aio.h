@@ -0,0 +1,27 @@
+#ifndef STW_INTERNAL_AIO_H
+#define STW_INTERNAL_AIO_H
+
+#include "stw/replay.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/* Read-ahead line reader: keeps `queue_depth` aligned blocks in flight ahead
+ * of the caller, via io_uring or, where that is unavailable, a reader thread.
+ * Reads with explicit offsets, so it never moves the fd's file position. */
+typedef struct stw_aio stw_aio_t;
+
+/* NULL on error or when unsupported on this platform (reason printed). */
+stw_aio_t *stw_aio_open(int fd, uint64_t offset, const stw_replay_io_opts_t *io);
+void       stw_aio_close(stw_aio_t *A);
+
+/* Same contract as getline(3): -1 at end of file or on error (reported);
+ * stw_aio_error() tells them apart, like ferror(3). */
+ssize_t stw_aio_getline(stw_aio_t *A, char **line, size_t *cap);
+bool    stw_aio_error(const stw_aio_t *A);
+
+/* "io_uring" or "thread (io_uring: <reason>)" */
+const char *stw_aio_backend(const stw_aio_t *A);
+
+#endif /* STW_INTERNAL_AIO_H */
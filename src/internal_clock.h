@@ -0,0 +1,14 @@
+#ifndef STW_INTERNAL_CLOCK_H
+#define STW_INTERNAL_CLOCK_H
+
+#include <stdint.h>
+
+/* Monotonic clock and pacing, defined in clock.c. */
+
+uint64_t stw_replay_now_ns(void);
+void     stw_replay_sleep_until(uint64_t target_ns);
+
+/* Sleep until `spin_ns` before the deadline, then busy-wait the rest. */
+void stw_replay_wait_until(uint64_t target_ns, uint64_t spin_ns);
+
+#endif /* STW_INTERNAL_CLOCK_H */
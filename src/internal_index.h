@@ -0,0 +1,37 @@
+#ifndef STW_INTERNAL_INDEX_H
+#define STW_INTERNAL_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* opts.instruments split at commas, sorted and de-duplicated for exact lookups. */
+typedef struct {
+	char        *buf;
+	const char **names;
+	uint32_t     n;
+} stw_inst_list_t;
+
+bool stw_inst_list_parse(stw_inst_list_t *L, const char *csv);
+bool stw_inst_list_has(const stw_inst_list_t *L, const char *name, size_t len);
+void stw_inst_list_free(stw_inst_list_t *L);
+
+/* Merged cursor over the posting lists of exactly the instruments in `insts`;
+ * yields (offset, len) in ascending offset order. */
+typedef struct stw_index_sel stw_index_sel_t;
+
+/* NULL if the index is missing, invalid, stale for `logfile` or built on
+ * another `inst_key` (reason printed). */
+stw_index_sel_t *stw_index_select(
+    const char            *index_path,
+    const char            *logfile,
+    const char            *inst_key,
+    const stw_inst_list_t *insts
+);
+void stw_index_sel_free(stw_index_sel_t *S);
+
+/* Position at the first line starting at or after `offset`. */
+void stw_index_sel_seek(stw_index_sel_t *S, uint64_t offset);
+bool stw_index_sel_next(stw_index_sel_t *S, uint64_t *offset, uint32_t *len);
+
+#endif /* STW_INTERNAL_INDEX_H */
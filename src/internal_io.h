@@ -0,0 +1,48 @@
+#ifndef STW_INTERNAL_IO_H
+#define STW_INTERNAL_IO_H
+
+/* stdio portability shims shared by the log readers (getline, 64-bit seek).
+ * Define _GNU_SOURCE before including, as the readers do. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Cross-platform getline fallback */
+#if defined(_WIN32) || (!defined(_GNU_SOURCE) && !defined(__USE_POSIX) && !defined(__APPLE__))
+static inline ssize_t
+stw_replay_getline(char **buf, size_t *cap, FILE *f)
+{
+	if (!*buf || *cap == 0) {
+		*cap = 256;
+		*buf = (char *)malloc(*cap);
+		if (!*buf) return -1;
+	}
+	size_t len = 0;
+	for (;;) {
+		if (!fgets(*buf + len, (int)(*cap - len), f)) {
+			return (len > 0) ? (ssize_t)len : -1;
+		}
+		len += strlen(*buf + len);
+		if (len > 0 && (*buf)[len - 1] == '\n') {
+			return (ssize_t)len;
+		}
+		size_t ncap = (*cap < 1024) ? (*cap * 2) : (*cap + *cap / 2);
+		char  *nb   = (char *)realloc(*buf, ncap);
+		if (!nb) return (ssize_t)len;
+		*buf = nb;
+		*cap = ncap;
+	}
+}
+#define getline stw_replay_getline
+#endif
+
+#if defined(_WIN32)
+#define stw_fseek _fseeki64
+#define stw_ftell _ftelli64
+#else
+#define stw_fseek fseeko
+#define stw_ftell ftello
+#endif
+
+#endif /* STW_INTERNAL_IO_H */
@@ -0,0 +1,11 @@
+#ifndef STW_INTERNAL_MAP_H
+#define STW_INTERNAL_MAP_H
+
+#include <stddef.h>
+
+/* Read-only whole-file mapping: mmap on POSIX, an aligned heap copy on
+ * Windows. Returns NULL on error (errno set); `*len` receives the size. */
+void *stw_map_file(const char *path, size_t *len);
+void  stw_unmap_file(void *base, size_t len);
+
+#endif /* STW_INTERNAL_MAP_H */
@@ -0,0 +1,22 @@
+#ifndef STW_INTERNAL_PARSER_H
+#define STW_INTERNAL_PARSER_H
+
+#include "stw/replay.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Log line parsing and the flat JSON key scanner, defined in parser.c. */
+
+bool _stw_parser_try_extract(const char *line, const char *filter, stw_log_frame_t *out);
+
+/* Scalar value of `"key":` anywhere in json[0..len); strings without quotes. */
+bool stw_json_find_scalar(
+    const char  *json,
+    size_t       len,
+    const char  *key,
+    const char **val,
+    size_t      *vlen
+);
+
+#endif /* STW_INTERNAL_PARSER_H */
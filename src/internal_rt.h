@@ -0,0 +1,41 @@
+#ifndef STW_INTERNAL_RT_H
+#define STW_INTERNAL_RT_H
+
+#include "stw/replay.h"
+
+#if defined(_WIN32)
+#include <stdint.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/* Thread state changed by stw_rt_apply(), put back by stw_rt_restore(). */
+typedef struct {
+	bool pinned;
+	bool sched;
+#if defined(_WIN32)
+	uintptr_t mask;
+	int       priority;
+#else
+#if defined(__linux__)
+	cpu_set_t cpus;
+#endif
+	int                policy;
+	struct sched_param param;
+#endif
+} stw_rt_saved_t;
+
+/* Pin, SCHED_FIFO, mlockall and stack pre-fault, in that order. The line
+ * buffer pre-fault and the parse warm-up are done by the caller. */
+void stw_rt_apply(
+    const stw_replay_rt_opts_t *o,
+    stw_rt_saved_t             *saved,
+    stw_replay_rt_report_t     *rep
+);
+void stw_rt_restore(const stw_rt_saved_t *saved);
+
+/* One "replay: realtime ..." line on stderr summarising `rep`. */
+void stw_rt_print(const stw_replay_rt_opts_t *o, const stw_replay_rt_report_t *rep);
+
+#endif /* STW_INTERNAL_RT_H */
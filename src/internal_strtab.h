@@ -0,0 +1,32 @@
+#ifndef STW_INTERNAL_STRTAB_H
+#define STW_INTERNAL_STRTAB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* String interning table shared by the tick store and the instrument index.
+ * Names live NUL-terminated in one blob; ids are dense, in first-seen order.
+ * `off` always has room for a sentinel entry at `off[n]`. */
+typedef struct {
+	char     *names;
+	size_t    names_len;
+	size_t    names_cap;
+	uint32_t *off;
+	uint32_t  n;
+	uint32_t  cap;
+	uint32_t *slots; /* id + 1, 0 = empty */
+	uint32_t  n_slots;
+} stw_strtab_t;
+
+bool stw_strtab_intern(stw_strtab_t *T, const char *s, size_t len, uint32_t *id_out);
+bool stw_strtab_finish(stw_strtab_t *T); /* writes the sentinel off[n] = names_len */
+void stw_strtab_free(stw_strtab_t *T);
+
+static inline const char *
+stw_strtab_name(const stw_strtab_t *T, uint32_t id)
+{
+	return T->names + T->off[id];
+}
+
+#endif /* STW_INTERNAL_STRTAB_H */
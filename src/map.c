@@ -0,0 +1,69 @@
+#if !defined(_WIN32)
+#define _GNU_SOURCE
+#endif
+
+#include "internal_map.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+void *
+stw_map_file(const char *path, size_t *len)
+{
+	if (!path || !len) {
+		errno = EINVAL;
+		return NULL;
+	}
+#if defined(_WIN32)
+	FILE *fp = fopen(path, "rb");
+	if (!fp) return NULL;
+	_fseeki64(fp, 0, SEEK_END);
+	size_t n = (size_t)_ftelli64(fp);
+	_fseeki64(fp, 0, SEEK_SET);
+	void *base = _aligned_malloc(n ? n : 1, 4096);
+	if (base && fread(base, 1, n, fp) != n) {
+		_aligned_free(base);
+		base  = NULL;
+		errno = EIO;
+	}
+	fclose(fp);
+	if (base) *len = n;
+	return base;
+#else
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return NULL;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		errno = EINVAL;
+		return NULL;
+	}
+	void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) return NULL;
+	*len = (size_t)st.st_size;
+	return base;
+#endif
+}
+
+void
+stw_unmap_file(void *base, size_t len)
+{
+	if (!base) return;
+#if defined(_WIN32)
+	(void)len;
+	_aligned_free(base);
+#else
+	munmap(base, len);
+#endif
+}
@@ -1,5 +1,7 @@
 #include "stw/replay.h"
 
+#include "internal_parser.h"
+
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -72,8 +74,51 @@ stw_parser_try_extract(const char *line, const char *filter, stw_log_frame_t *ou
 	return true;
 }
 
-/* Expose as non-header function (internal linkage from replay.c) */
-bool _stw_parser_try_extract(const char *line, const char *filter, stw_log_frame_t *out);
+/* Find the scalar value of `"key":` inside json[0..len). Strings are returned
+ * without quotes (escapes untouched), numbers/literals as-is. This is a
+ * scanner, not a parser: the first match at any depth wins, which is what the
+ * flat broker payloads need. */
+bool
+stw_json_find_scalar(const char *json, size_t len, const char *key, const char **val, size_t *vlen)
+{
+	if (!json || !key || !val || !vlen) return false;
+	size_t      klen = strlen(key);
+	const char *end  = json + len;
+
+	for (const char *p = json; p + klen + 2 < end; p++) {
+		if (*p != '"' || p[klen + 1] != '"' || memcmp(p + 1, key, klen) != 0) continue;
+		const char *q = p + klen + 2;
+		while (q < end && (*q == ' ' || *q == '\t'))
+			++q;
+		if (q >= end || *q != ':') continue;
+		++q;
+		while (q < end && (*q == ' ' || *q == '\t'))
+			++q;
+		if (q >= end) return false;
+
+		if (*q == '"') {
+			const char *s = ++q;
+			while (q < end && *q != '"') {
+				if (*q == '\\' && q + 1 < end) ++q;
+				++q;
+			}
+			if (q >= end) return false;
+			*val  = s;
+			*vlen = (size_t)(q - s);
+			return true;
+		}
+		if (*q == '{' || *q == '[') continue; /* not a scalar; keep looking */
+		const char *s = q;
+		while (q < end && *q != ',' && *q != '}' && *q != ']' && *q != ' ' && *q != '\t')
+			++q;
+		*val  = s;
+		*vlen = (size_t)(q - s);
+		return q > s;
+	}
+	return false;
+}
+
+/* Exposed to the other translation units through internal_parser.h */
 bool
 _stw_parser_try_extract(const char *line, const char *filter, stw_log_frame_t *out)
 {
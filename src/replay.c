@@ -4,6 +4,13 @@
 
 #include "stw/replay.h"
 
+#include "internal_aio.h"
+#include "internal_clock.h"
+#include "internal_index.h"
+#include "internal_io.h"
+#include "internal_parser.h"
+#include "internal_rt.h"
+
 #include <assert.h>
 #include <errno.h>
 #include <inttypes.h>
@@ -18,51 +25,32 @@
 #include <unistd.h>
 #endif
 
-#if defined(__APPLE__)
-#define STW_CLOCK_MONO CLOCK_MONOTONIC
-#elif !defined(_WIN32)
-#define STW_CLOCK_MONO CLOCK_MONOTONIC_RAW
-#endif
-
-/* internal from parser.c */
-bool _stw_parser_try_extract(const char *line, const char *filter, stw_log_frame_t *out);
-void stw_replay_sleep_until(uint64_t target_ns);
-
-/* Cross-platform getline fallback */
-#if defined(_WIN32) || (!defined(_GNU_SOURCE) && !defined(__USE_POSIX) && !defined(__APPLE__))
-static ssize_t
-stw_replay_getline(char **buf, size_t *cap, FILE *f)
-{
-	if (!*buf || *cap == 0) {
-		*cap = 256;
-		*buf = (char *)malloc(*cap);
-		if (!*buf) return -1;
-	}
-	size_t len = 0;
-	for (;;) {
-		if (!fgets(*buf + len, (int)(*cap - len), f)) {
-			return (len > 0) ? (ssize_t)len : -1;
-		}
-		len += strlen(*buf + len);
-		if (len > 0 && (*buf)[len - 1] == '\n') {
-			return (ssize_t)len;
-		}
-		size_t ncap = (*cap < 1024) ? (*cap * 2) : (*cap + *cap / 2);
-		char  *nb   = (char *)realloc(*buf, ncap);
-		if (!nb) return (ssize_t)len;
-		*buf = nb;
-		*cap = ncap;
-	}
-}
-#define getline stw_replay_getline
-#endif
-
 struct stw_replay {
-	stw_replay_opts_t opt;
-	FILE             *fp;
-	uint64_t          first_ns; /* ns of first accepted frame */
+	stw_replay_opts_t       opt;
+	FILE                   *fp;
+	uint64_t                first_ns;  /* ns of first accepted frame */
+	uint64_t                pos;       /* byte offset of the next unread line */
+	uint64_t                last_ns;   /* ns of the last delivered frame */
+	uint64_t                delivered; /* frames delivered across all passes */
+	uint64_t                loop_iter; /* completed passes over the file */
+	bool                    resuming;  /* next pass continues from `cp` instead of offset 0 */
+	stw_replay_checkpoint_t cp;
+	stw_inst_list_t         insts;     /* opt.instruments; n == 0 = every instrument */
+	stw_index_sel_t        *sel;       /* index cursor over `insts` via index_file, else NULL */
+	stw_aio_t              *aio;       /* read-ahead reader when opt.io.async, else NULL */
+	bool                    aio_noted; /* backend already reported */
+	char                   *line;      /* line buffer, kept across passes */
+	size_t                  cap;
+	stw_replay_rt_report_t  rt;        /* outcome of opt.realtime for the last run */
+	stw_rt_saved_t          rt_saved;  /* thread state to restore when the run ends */
+	int                     state;     /* RUN_IDLE / RUN_ACTIVE / RUN_DONE */
+	bool                    save_due;  /* checkpoint_every boundary reached by the last frame */
+	uint64_t                base_ns;   /* log ns of the first paced frame of this pass */
+	uint64_t                base_mono; /* monotonic ns when that frame was due */
 };
 
+enum { RUN_IDLE, RUN_ACTIVE, RUN_DONE };
+
 static FILE *
 xfopen(const char *path)
 {
@@ -73,12 +61,62 @@ xfopen(const char *path)
 	return f;
 }
 
+/* Restart read-ahead at `offset`; on failure reads fall back to stdio. */
+static void
+reopen_aio(struct stw_replay *R, uint64_t offset)
+{
+	stw_aio_close(R->aio);
+	R->aio = stw_aio_open(fileno(R->fp), offset, &R->opt.io);
+	if (R->aio && !R->aio_noted) {
+		R->aio_noted = true;
+		fprintf(stderr, "replay: read-ahead via %s\n", stw_aio_backend(R->aio));
+	}
+}
+
 static void
 reset_file(struct stw_replay *R)
 {
 	if (!R || !R->fp) return;
-	fseek(R->fp, 0, SEEK_SET);
-	R->first_ns = 0;
+	uint64_t offset = 0;
+	R->first_ns     = 0;
+	if (R->resuming) {
+		R->resuming = false;
+		offset      = R->cp.offset;
+		R->first_ns = R->cp.first_ns;
+	}
+	stw_fseek(R->fp, (int64_t)offset, SEEK_SET);
+	R->pos       = offset;
+	R->base_ns   = 0;
+	R->base_mono = 0;
+	if (R->sel)
+		stw_index_sel_seek(R->sel, offset);
+	else if (R->opt.io.async)
+		reopen_aio(R, offset);
+}
+
+static void
+autosave(const stw_replay_t *R)
+{
+	if (!R->opt.checkpoint_file) return;
+	stw_replay_checkpoint_t cp;
+	stw_replay_checkpoint(R, &cp);
+	if (stw_replay_checkpoint_save(R->opt.checkpoint_file, &cp) != 0) {
+		fprintf(
+		    stderr,
+		    "replay: checkpoint save('%s') failed: %s\n",
+		    R->opt.checkpoint_file,
+		    strerror(errno)
+		);
+	}
+}
+
+/* End of the run: undo the realtime settings and write the final checkpoint. */
+static void
+finish_run(stw_replay_t *R)
+{
+	if (R->opt.realtime.enable) stw_rt_restore(&R->rt_saved);
+	autosave(R);
+	R->state = RUN_DONE;
 }
 
 stw_replay_t *
@@ -94,88 +132,298 @@ stw_replay_create(const stw_replay_opts_t *opts)
 		free(R);
 		return NULL;
 	}
+	if (opts->resume) {
+		stw_fseek(R->fp, 0, SEEK_END);
+		int64_t size = stw_ftell(R->fp);
+		if (size < 0 || opts->resume->offset > (uint64_t)size) {
+			fprintf(
+			    stderr,
+			    "replay: resume offset %" PRIu64 " is past the end of '%s'\n",
+			    opts->resume->offset,
+			    R->opt.logfile
+			);
+			fclose(R->fp);
+			free(R);
+			return NULL;
+		}
+		R->cp         = *opts->resume;
+		R->resuming   = true;
+		R->last_ns    = R->cp.last_ns;
+		R->delivered  = R->cp.delivered;
+		R->loop_iter  = R->cp.loop_iter;
+		R->opt.resume = NULL; /* caller's storage need not outlive create() */
+	}
+	if (!R->opt.instrument_key) R->opt.instrument_key = "symbol";
+	if (R->opt.instruments && !stw_inst_list_parse(&R->insts, R->opt.instruments)) {
+		fclose(R->fp);
+		free(R);
+		return NULL;
+	}
+	if (R->opt.index_file && R->insts.n) {
+		/* falls back to a full scan when the index is unusable */
+		R->sel = stw_index_select(
+		    R->opt.index_file,
+		    R->opt.logfile,
+		    R->opt.instrument_key,
+		    &R->insts
+		);
+	}
 	return R;
 }
 
+int
+stw_replay_checkpoint(const stw_replay_t *R, stw_replay_checkpoint_t *out)
+{
+	if (!R || !out) return -1;
+	out->offset    = R->pos;
+	out->last_ns   = R->last_ns;
+	out->first_ns  = R->first_ns;
+	out->delivered = R->delivered;
+	out->loop_iter = R->loop_iter;
+	return 0;
+}
+
 void
 stw_replay_destroy(stw_replay_t *R)
 {
 	if (!R) return;
+	if (R->state == RUN_ACTIVE) finish_run(R); // pulled or stopped early: restore and save
+	stw_aio_close(R->aio); /* its reader may still be reading R->fp's descriptor */
 	if (R->fp) fclose(R->fp);
+	stw_index_sel_free(R->sel);
+	stw_inst_list_free(&R->insts);
+	free(R->line);
 	free(R);
 }
 
+/* Next candidate line: sequentially from the file (stdio or read-ahead), or
+ * only the indexed lines of the selected instruments. Returns 1 with a line,
+ * 0 at end of pass, -1 on a read error (reported). */
 static int
-run_once(stw_replay_t *R, stw_replay_msg_cb cb, void *user)
+read_line(stw_replay_t *R)
 {
-	char    *line      = NULL;
-	size_t   cap       = 0;
-	ssize_t  n         = 0;
-	uint64_t base_ns   = 0; // wall clock base when first frame delivered
+	if (!R->sel) {
+		ssize_t n = R->aio ? stw_aio_getline(R->aio, &R->line, &R->cap)
+		                   : getline(&R->line, &R->cap, R->fp);
+		if (n == -1) {
+			if (R->aio) return stw_aio_error(R->aio) ? -1 : 0; // already reported
+			if (!ferror(R->fp)) return 0;
+			fprintf(stderr, "replay: read failed in '%s': %s\n", R->opt.logfile, strerror(errno));
+			return -1;
+		}
+		R->pos += (uint64_t)n;
+		return 1;
+	}
 
-	uint64_t delivered = 0;
+	uint64_t off;
+	uint32_t len;
+	if (!stw_index_sel_next(R->sel, &off, &len)) return 0;
+	if (R->cap < (size_t)len + 1) {
+		char *nl = (char *)realloc(R->line, (size_t)len + 1);
+		if (!nl) return -1;
+		R->line = nl;
+		R->cap  = (size_t)len + 1;
+	}
+#if defined(_WIN32)
+	bool ok = stw_fseek(R->fp, (int64_t)off, SEEK_SET) == 0 &&
+	          fread(R->line, 1, len, R->fp) == len;
+#else
+	bool ok = pread(fileno(R->fp), R->line, len, (off_t)off) == (ssize_t)len;
+#endif
+	if (!ok) {
+		fprintf(stderr, "replay: short read at offset %" PRIu64 " in '%s'\n", off, R->opt.logfile);
+		return -1;
+	}
+	R->line[len] = '\0';
+	R->pos       = off + len;
+	return 1;
+}
 
-	while ((n = getline(&line, &cap, R->fp)) != -1) {
-		stw_log_frame_t f = {0};
-		if (!_stw_parser_try_extract(line, R->opt.filter_substr, &f))
-			continue; // not a WS frame we care about
+/* Parse the current line and apply filter_substr and the instrument list. */
+static bool
+accept_line(const stw_replay_t *R, stw_log_frame_t *f)
+{
+	if (!_stw_parser_try_extract(R->line, R->opt.filter_substr, f)) return false;
+	if (!R->insts.n || R->sel) return true; // the index already read only those instruments
+	const char *v  = NULL;
+	size_t      vn = 0;
+	return stw_json_find_scalar(f->json, f->json_len, R->opt.instrument_key, &v, &vn) &&
+	       stw_inst_list_has(&R->insts, v, vn);
+}
+
+/* Next frame of the current pass, paced: 1 with a frame, 0 at the end of the
+ * pass, -1 on a read error. */
+static int
+next_in_pass(stw_replay_t *R, stw_log_frame_t *f)
+{
+	uint64_t spin_ns = R->opt.realtime.enable ? (uint64_t)R->opt.realtime.spin_us * 1000 : 0;
+	int      rc;
+
+	while ((rc = read_line(R)) == 1) {
+		memset(f, 0, sizeof(*f));
+		if (!accept_line(R, f)) continue; // not a WS frame we care about
 
 		if (R->first_ns == 0) {
-			R->first_ns = f.ns;
+			R->first_ns = f->ns;
 		}
 		// Apply start offset (in seconds) by skipping frames earlier than first_ns + offset
 		uint64_t start_cut = R->first_ns + (uint64_t)(R->opt.start_offset_s * 1e9);
-		if (f.ns < start_cut) continue;
+		if (f->ns < start_cut) continue;
 
 		if (!R->opt.no_sleep) {
-			if (base_ns == 0) {
-				base_ns = f.ns;
+			if (R->base_ns == 0) {
+				R->base_ns   = f->ns;
+				R->base_mono = stw_replay_now_ns(); // wall clock epoch for this pass
 			}
 			// replay time = (f.ns - base_ns)/speed
-			double          rel_ns = (double)(f.ns - base_ns) / R->opt.speed;
-			static uint64_t t0     = 0;
-			if (!t0) {
-				t0 = 1;
-			}
-			// Use monotonic now as epoch 0
-			uint64_t now0 = 0;
-			{
-#if defined(_WIN32)
-				static LARGE_INTEGER freq = {0};
-				if (freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
-				LARGE_INTEGER ctr;
-				QueryPerformanceCounter(&ctr);
-				now0 = (uint64_t)((double)ctr.QuadPart / (double)freq.QuadPart * 1e9);
-#else
-				struct timespec ts;
-				clock_gettime(STW_CLOCK_MONO, &ts);
-				now0 = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
-#endif
-			}
-			uint64_t target = now0 + (uint64_t)rel_ns;
-			stw_replay_sleep_until(target);
+			double   rel_ns = (double)(f->ns - R->base_ns) / R->opt.speed;
+			uint64_t target = R->base_mono + (uint64_t)rel_ns;
+			stw_replay_wait_until(target, spin_ns);
 		}
+		return 1;
+	}
+	return rc;
+}
 
-		cb(user, f.json, f.json_len);
-		if (R->opt.hard_stop_count && ++delivered >= R->opt.hard_stop_count) break;
+/* Read and parse the first frames of the pass without delivering them, so the
+ * page cache, parser code and line buffer are hot before the first deadline. */
+static uint32_t
+rt_warmup(stw_replay_t *R, uint32_t frames)
+{
+	bool     resuming = R->resuming;
+	uint32_t n        = 0;
+	reset_file(R);
+	while (n < frames && read_line(R) == 1) {
+		stw_log_frame_t f = {0};
+		if (accept_line(R, &f)) n++;
 	}
+	(void)stw_replay_now_ns();
+	R->resuming = resuming; /* the real pass rewinds to the same start */
+	return n;
+}
 
-	free(line);
+static void
+rt_start(stw_replay_t *R, stw_rt_saved_t *saved)
+{
+	const stw_replay_rt_opts_t *o = &R->opt.realtime;
+	memset(&R->rt, 0, sizeof(R->rt));
+	stw_rt_apply(o, saved, &R->rt);
+
+	size_t bytes = o->prefault_bytes ? o->prefault_bytes : 64 * 1024;
+	if (R->cap < bytes) {
+		char *nl = (char *)realloc(R->line, bytes);
+		if (nl) {
+			R->line = nl;
+			R->cap  = bytes;
+		}
+	}
+	if (R->cap >= bytes) {
+		memset(R->line, 0, R->cap);
+		R->rt.prefault       = STW_RT_OK;
+		R->rt.prefault_bytes = R->cap;
+	} else {
+		R->rt.prefault = STW_RT_FAILED;
+	}
+
+	R->rt.warmup_frames = rt_warmup(R, o->warmup_frames ? o->warmup_frames : 64);
+	R->rt.warmup        = STW_RT_OK;
+	stw_rt_print(o, &R->rt);
+}
+
+int
+stw_replay_rt_report(const stw_replay_t *R, stw_replay_rt_report_t *out)
+{
+	if (!R || !out) return -1;
+	*out = R->rt;
 	return 0;
 }
 
 int
-stw_replay_run(stw_replay_t *R, stw_replay_msg_cb cb, void *user)
+stw_replay_next(stw_replay_t *R, stw_log_frame_t *out)
 {
-	if (!R || !cb) return -1;
-	do {
+	if (!R || !out) return -1;
+	if (R->state == RUN_DONE) return 0;
+	if (R->state == RUN_IDLE) {
+		if (!R->resuming) { // a new run counts from zero; only a resume carries totals over
+			R->delivered = 0;
+			R->loop_iter = 0;
+			R->last_ns   = 0;
+		}
+		R->save_due = false;
+		if (R->opt.realtime.enable) rt_start(R, &R->rt_saved);
 		reset_file(R);
-		int rc = run_once(R, cb, user);
-		if (rc) return rc;
-	} while (R->opt.loop);
+		R->state = RUN_ACTIVE;
+	}
+	if (R->save_due) { // after the caller is done with the previous frame
+		R->save_due = false;
+		autosave(R);
+	}
+
+	for (;;) {
+		// Before reading: a session resumed at the hard stop delivers nothing more
+		if (R->opt.hard_stop_count && R->delivered >= R->opt.hard_stop_count) break;
+		int rc = next_in_pass(R, out);
+		if (rc > 0) {
+			// Count before handing it out so a checkpoint taken now covers this frame
+			R->last_ns = out->ns;
+			R->delivered++;
+			R->save_due = R->opt.checkpoint_every && R->delivered % R->opt.checkpoint_every == 0;
+			return 1;
+		}
+		if (rc < 0) { // not an end of pass: no next pass, and the caller must know
+			finish_run(R);
+			return -1;
+		}
+		if (!R->opt.loop) break;
+		R->loop_iter++;
+		reset_file(R);
+	}
+	finish_run(R);
 	return 0;
 }
 
+int
+stw_replay_end(stw_replay_t *R)
+{
+	if (!R) return -1;
+	if (R->state == RUN_ACTIVE) finish_run(R);
+	R->state = RUN_IDLE;
+	return 0;
+}
+
+int
+stw_replay_run_frames(stw_replay_t *R, stw_replay_frame_cb cb, void *user)
+{
+	if (!R || !cb) return -1;
+	stw_log_frame_t f;
+	int             rc;
+	while ((rc = stw_replay_next(R, &f)) == 1)
+		cb(user, &f);
+	stw_replay_end(R); // each run replays again
+	return rc < 0 ? rc : 0;
+}
+
+/* Adapts the frame-level callback back to the plain (user,json,len) shape */
+typedef struct {
+	stw_replay_msg_cb cb;
+	void             *user;
+} msg_adapter_t;
+
+static void
+msg_adapter(void *u, const stw_log_frame_t *f)
+{
+	msg_adapter_t *A = (msg_adapter_t *)u;
+	A->cb(A->user, f->json, f->json_len);
+}
+
+int
+stw_replay_run(stw_replay_t *R, stw_replay_msg_cb cb, void *user)
+{
+	if (!R || !cb) return -1;
+	msg_adapter_t A = {.cb = cb, .user = user};
+	return stw_replay_run_frames(R, msg_adapter, &A);
+}
+
 int
 stw_replay_run_simple(const stw_replay_opts_t *opts, stw_replay_msg_cb cb, void *user)
 {
@@ -187,6 +435,28 @@ stw_replay_run_simple(const stw_replay_opts_t *opts, stw_replay_msg_cb cb, void
 }
 
 #ifdef STW_REPLAY_BUILD_CLI
+#include "stw/replay_index.h"
+#include "stw/replay_runner.h"
+#include "stw/replay_shm.h"
+#include "stw/replay_ticks.h"
+
+#if !defined(_WIN32)
+#include <signal.h>
+#include <sys/mman.h>
+
+/* --shm: a publisher stopped with Ctrl-C or kill must not leave its ring behind;
+ * attached readers notice the dead pid on their own. */
+static const char *shm_ring;
+
+static void
+unlink_ring_and_die(int sig)
+{
+	shm_unlink(shm_ring);
+	signal(sig, SIG_DFL);
+	raise(sig);
+}
+#endif
+
 /* Minimal CLI that just prints JSON or does nothing (useful for timing validation) */
 static void
 sink(void *user, const char *json, size_t len)
@@ -197,13 +467,152 @@ sink(void *user, const char *json, size_t len)
 	fflush(stdout);
 }
 
+/* --batch mode: one counting context per session, built by the runner factory */
+typedef struct {
+	uint64_t frames;
+	uint64_t bytes;
+} batch_ctx_t;
+
+static void
+batch_count(void *user, const char *json, size_t len)
+{
+	batch_ctx_t *C = (batch_ctx_t *)user;
+	(void)json;
+	C->frames++;
+	C->bytes += len;
+}
+
+static int
+batch_create(void *fu, const stw_replay_session_t *s, stw_replay_msg_cb *cb, void **ctx)
+{
+	(void)fu;
+	(void)s;
+	*cb  = batch_count;
+	*ctx = calloc(1, sizeof(batch_ctx_t));
+	return *ctx ? 0 : -1;
+}
+
+static void
+batch_destroy(void *fu, const stw_replay_session_t *s, void *ctx)
+{
+	batch_ctx_t *C = (batch_ctx_t *)ctx;
+	(void)fu;
+	fprintf(
+	    stderr,
+	    "[%4zu] w%-3u rc=%d frames=%" PRIu64 " bytes=%" PRIu64 " t=%.3fs  %s\n",
+	    s->index,
+	    s->worker,
+	    s->rc,
+	    C->frames,
+	    C->bytes,
+	    (double)s->wall_ns / 1e9,
+	    s->logfile
+	);
+	free(C);
+}
+
+static int
+run_batch(const stw_replay_opts_t *opt, const char *listfile, unsigned threads)
+{
+	FILE *lf = fopen(listfile, "rb");
+	if (!lf) {
+		fprintf(stderr, "replay: fopen('%s') failed: %s\n", listfile, strerror(errno));
+		return 1;
+	}
+	char  **logs = NULL;
+	size_t  n = 0, cap = 0, lcap = 0;
+	char   *line = NULL;
+	ssize_t len;
+	while ((len = getline(&line, &lcap, lf)) != -1) {
+		while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+			line[--len] = '\0';
+		if (len == 0 || line[0] == '#') continue;
+		if (n == cap) {
+			size_t ncap = cap ? cap * 2 : 64;
+			char **nl   = (char **)realloc(logs, ncap * sizeof(*logs));
+			if (!nl) break;
+			logs = nl;
+			cap  = ncap;
+		}
+		logs[n] = strdup(line);
+		if (logs[n]) n++;
+	}
+	free(line);
+	fclose(lf);
+
+	stw_replay_session_t    *res = (stw_replay_session_t *)calloc(n ? n : 1, sizeof(*res));
+	stw_replay_runner_opts_t ro  = {
+	    .base       = opt,
+	    .logfiles   = (const char *const *)logs,
+	    .n_logfiles = n,
+	    .threads    = threads,
+	    .create     = batch_create,
+	    .destroy    = batch_destroy,
+	};
+	uint64_t t0     = stw_replay_now_ns();
+	int      failed = res ? stw_replay_runner_run(&ro, res) : -1;
+	uint64_t frames = 0;
+	for (size_t i = 0; res && i < n; i++)
+		frames += res[i].delivered;
+	double secs = (double)(stw_replay_now_ns() - t0) / 1e9;
+	fprintf(
+	    stderr,
+	    "batch: %zu sessions, %d failed, %" PRIu64 " frames in %.3fs (%.0f frames/s)\n",
+	    n,
+	    failed,
+	    frames,
+	    secs,
+	    secs > 0 ? (double)frames / secs : 0.0
+	);
+
+	for (size_t i = 0; i < n; i++)
+		free(logs[i]);
+	free(logs);
+	free(res);
+	return failed == 0 ? 0 : 1;
+}
+
+/* --export-ticks mode */
+typedef struct {
+	const char *out;
+	const char *keys; /* "ts,inst,price,qty"; empty entries keep the default */
+} ticks_cli_t;
+
+static int
+export_ticks(const stw_replay_opts_t *opt, const ticks_cli_t *cli)
+{
+	stw_ticks_export_opts_t xo      = {0};
+	char                   *keys    = cli->keys ? strdup(cli->keys) : NULL;
+	const char            **slots[] = {&xo.ts_key, &xo.inst_key, &xo.price_key, &xo.qty_key};
+	char                   *p       = keys;
+	for (size_t k = 0; p && k < sizeof(slots) / sizeof(slots[0]); k++) {
+		char *comma = strchr(p, ',');
+		if (comma) *comma = '\0';
+		if (*p) *slots[k] = p;
+		p = comma ? comma + 1 : NULL;
+	}
+
+	int64_t rows = stw_ticks_export(opt, cli->out, &xo);
+	free(keys);
+	if (rows < 0) return 1;
+	fprintf(stderr, "replay: wrote %" PRId64 " ticks to %s\n", rows, cli->out);
+	return 0;
+}
+
 static void
 usage(const char *argv0)
 {
 	fprintf(
 	    stderr,
-	    "Usage: %s -f <logfile> [-s speed] [-o start_s] [--loop] [--no-sleep] [--filter "
-	    "str] [--max N]\n",
+	    "Usage: %s {-f <logfile> | --batch <listfile> [-j N]}\n"
+	    "          [-s speed] [-o start_s] [--loop] [--no-sleep] [--filter str] [--max N]\n"
+	    "          [--shm name [--shm-slots N] [--shm-slot-size B] [--shm-readers N]]\n"
+	    "          [--checkpoint file [--checkpoint-every N]]\n"
+	    "          [--export-ticks out [--tick-keys ts,inst,price,qty]]\n"
+	    "          [--inst A,B,...] [--index idx] [--build-index idx] [--index-key K]\n"
+	    "          [--rt] [--rt-cpu N] [--rt-fifo prio] [--rt-mlock] [--rt-prefault B]\n"
+	    "          [--rt-warmup N] [--rt-spin us]\n"
+	    "          [--async [--io-depth N] [--io-block B] [--no-uring]]\n",
 	    argv0
 	);
 }
@@ -211,8 +620,14 @@ usage(const char *argv0)
 int
 main(int argc, char **argv)
 {
-	stw_replay_opts_t opt = {0};
-	opt.speed             = 1.0;
+	stw_replay_opts_t       opt     = {0};
+	stw_replay_shm_opts_t   shm     = {0};
+	stw_replay_checkpoint_t cp      = {0};
+	ticks_cli_t             ticks   = {0};
+	const char             *batch   = NULL;
+	const char             *idx_out = NULL;
+	unsigned                threads = 0;
+	opt.speed                       = 1.0;
 	for (int i = 1; i < argc; i++) {
 		if (!strcmp(argv[i], "-f") && i + 1 < argc)
 			opt.logfile = argv[++i];
@@ -228,16 +643,100 @@ main(int argc, char **argv)
 			opt.filter_substr = argv[++i];
 		else if (!strcmp(argv[i], "--max") && i + 1 < argc)
 			opt.hard_stop_count = (uint64_t)strtoull(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "--shm") && i + 1 < argc)
+			shm.name = argv[++i];
+		else if (!strcmp(argv[i], "--shm-slots") && i + 1 < argc)
+			shm.slot_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "--shm-slot-size") && i + 1 < argc)
+			shm.slot_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "--shm-readers") && i + 1 < argc)
+			shm.wait_readers = (uint32_t)strtoul(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "--checkpoint") && i + 1 < argc)
+			opt.checkpoint_file = argv[++i];
+		else if (!strcmp(argv[i], "--checkpoint-every") && i + 1 < argc)
+			opt.checkpoint_every = (uint64_t)strtoull(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "--batch") && i + 1 < argc)
+			batch = argv[++i];
+		else if (!strcmp(argv[i], "-j") && i + 1 < argc)
+			threads = (unsigned)strtoul(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "--export-ticks") && i + 1 < argc)
+			ticks.out = argv[++i];
+		else if (!strcmp(argv[i], "--tick-keys") && i + 1 < argc)
+			ticks.keys = argv[++i];
+		else if (!strcmp(argv[i], "--index") && i + 1 < argc)
+			opt.index_file = argv[++i];
+		else if (!strcmp(argv[i], "--build-index") && i + 1 < argc)
+			idx_out = argv[++i];
+		else if (!strcmp(argv[i], "--inst") && i + 1 < argc)
+			opt.instruments = argv[++i];
+		else if (!strcmp(argv[i], "--index-key") && i + 1 < argc)
+			opt.instrument_key = argv[++i];
+		else if (!strcmp(argv[i], "--rt"))
+			opt.realtime.enable = true;
+		else if (!strcmp(argv[i], "--rt-cpu") && i + 1 < argc) {
+			opt.realtime.pin = true;
+			opt.realtime.cpu = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "--rt-fifo") && i + 1 < argc)
+			opt.realtime.fifo_priority = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--rt-mlock"))
+			opt.realtime.lock_memory = true;
+		else if (!strcmp(argv[i], "--rt-prefault") && i + 1 < argc)
+			opt.realtime.prefault_bytes = (size_t)strtoull(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "--rt-warmup") && i + 1 < argc)
+			opt.realtime.warmup_frames = (uint32_t)strtoul(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "--rt-spin") && i + 1 < argc)
+			opt.realtime.spin_us = (uint32_t)strtoul(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "--async"))
+			opt.io.async = true;
+		else if (!strcmp(argv[i], "--io-depth") && i + 1 < argc)
+			opt.io.queue_depth = (uint32_t)strtoul(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "--io-block") && i + 1 < argc)
+			opt.io.block_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+		else if (!strcmp(argv[i], "--no-uring"))
+			opt.io.no_uring = true;
 		else {
 			usage(argv[0]);
 			return 2;
 		}
 	}
+	const stw_replay_rt_opts_t *rt = &opt.realtime;
+	if (rt->pin || rt->fifo_priority || rt->lock_memory || rt->prefault_bytes ||
+	    rt->warmup_frames || rt->spin_us)
+		opt.realtime.enable = true; /* any --rt-* flag implies --rt */
+	if (batch) return run_batch(&opt, batch, threads);
 	if (!opt.logfile) {
 		usage(argv[0]);
 		return 2;
 	}
+	if (idx_out) {
+		int64_t n = stw_replay_index_build(opt.logfile, idx_out, opt.instrument_key);
+		if (n < 0) return 1;
+		fprintf(stderr, "replay: indexed %" PRId64 " lines into %s\n", n, idx_out);
+		return 0;
+	}
+
+	if (ticks.out) return export_ticks(&opt, &ticks); /* whole log, checkpoint untouched */
+
+	/* An existing checkpoint file means "continue where the last run stopped" */
+	if (opt.checkpoint_file && stw_replay_checkpoint_load(opt.checkpoint_file, &cp) == 0) {
+		fprintf(
+		    stderr,
+		    "replay: resuming at offset %" PRIu64 " after %" PRIu64 " frames\n",
+		    cp.offset,
+		    cp.delivered
+		);
+		opt.resume = &cp;
+	}
 
+	if (shm.name) {
+#if !defined(_WIN32)
+		shm_ring = shm.name;
+		signal(SIGINT, unlink_ring_and_die);
+		signal(SIGTERM, unlink_ring_and_die);
+#endif
+		return stw_replay_shm_publish(&opt, &shm);
+	}
 	return stw_replay_run_simple(&opt, &sink, NULL);
 }
 #endif
@@ -0,0 +1,200 @@
+#if !defined(_WIN32)
+#define _GNU_SOURCE
+#endif
+
+#include "stw/replay.h"
+
+#include "internal_rt.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <malloc.h>
+#include <windows.h>
+#define stw_alloca _alloca
+#else
+#include <sys/mman.h>
+#if defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+#include <stdlib.h>
+#else
+#include <alloca.h>
+#endif
+#define stw_alloca alloca
+#endif
+
+#if defined(_MSC_VER)
+#define STW_NOINLINE __declspec(noinline)
+#else
+#define STW_NOINLINE __attribute__((noinline))
+#endif
+
+/* Deepest stack we pre-touch; the delivery path itself needs far less. */
+#define RT_STACK_MAX (256u * 1024u)
+
+/* Touch the `bytes` of stack right below the caller, nearest page first, so
+ * the first deadlines don't fault. Sized with alloca: a fixed array would sit
+ * at the deep end of the frame and leave the pages the delivery path uses cold. */
+static STW_NOINLINE void
+prefault_stack(size_t bytes)
+{
+	if (bytes > RT_STACK_MAX) bytes = RT_STACK_MAX;
+	if (!bytes) return;
+	volatile char *buf = (volatile char *)stw_alloca(bytes);
+	for (size_t i = 0; i < bytes; i += 4096)
+		buf[bytes - 1 - i] = 0;
+	buf[0] = 0;
+}
+
+static void
+apply_pin(int cpu, stw_rt_saved_t *saved, stw_replay_rt_report_t *rep)
+{
+#if defined(_WIN32)
+	if (cpu < 0 || cpu >= (int)(sizeof(DWORD_PTR) * 8)) {
+		rep->pin       = STW_RT_FAILED;
+		rep->pin_errno = EINVAL;
+		return;
+	}
+	DWORD_PTR old = SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu);
+	if (!old) {
+		rep->pin       = STW_RT_FAILED;
+		rep->pin_errno = EINVAL;
+		return;
+	}
+	saved->mask   = (uintptr_t)old;
+	saved->pinned = true;
+	rep->pin      = STW_RT_OK;
+#elif defined(__linux__)
+	if (cpu < 0 || cpu >= CPU_SETSIZE) {
+		rep->pin       = STW_RT_FAILED;
+		rep->pin_errno = EINVAL;
+		return;
+	}
+	pthread_t self = pthread_self();
+	int       rc   = pthread_getaffinity_np(self, sizeof(saved->cpus), &saved->cpus);
+	if (rc == 0) {
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		rc = pthread_setaffinity_np(self, sizeof(set), &set);
+	}
+	if (rc != 0) {
+		rep->pin       = STW_RT_FAILED;
+		rep->pin_errno = rc;
+		return;
+	}
+	saved->pinned = true;
+	rep->pin      = STW_RT_OK;
+#else
+	(void)cpu;
+	(void)saved;
+	rep->pin = STW_RT_UNSUPPORTED;
+#endif
+}
+
+static void
+apply_fifo(int priority, stw_rt_saved_t *saved, stw_replay_rt_report_t *rep)
+{
+#if defined(_WIN32)
+	(void)priority; /* no FIFO class; the closest is a time-critical thread */
+	HANDLE self     = GetCurrentThread();
+	saved->priority = GetThreadPriority(self);
+	if (!SetThreadPriority(self, THREAD_PRIORITY_TIME_CRITICAL)) {
+		rep->fifo       = STW_RT_FAILED;
+		rep->fifo_errno = EPERM;
+		return;
+	}
+	saved->sched = true;
+	rep->fifo    = STW_RT_OK;
+#else
+	pthread_t self = pthread_self();
+	int       rc   = pthread_getschedparam(self, &saved->policy, &saved->param);
+	if (rc == 0) {
+		struct sched_param sp;
+		memset(&sp, 0, sizeof(sp));
+		sp.sched_priority = priority;
+		rc                = pthread_setschedparam(self, SCHED_FIFO, &sp);
+	}
+	if (rc != 0) {
+		rep->fifo       = STW_RT_FAILED;
+		rep->fifo_errno = rc;
+		return;
+	}
+	saved->sched = true;
+	rep->fifo    = STW_RT_OK;
+#endif
+}
+
+static void
+apply_mlock(stw_replay_rt_report_t *rep)
+{
+#if defined(_WIN32)
+	rep->mlock = STW_RT_UNSUPPORTED;
+#else
+	if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+		rep->mlock       = STW_RT_FAILED;
+		rep->mlock_errno = errno;
+		return;
+	}
+	rep->mlock = STW_RT_OK;
+#endif
+}
+
+void
+stw_rt_apply(const stw_replay_rt_opts_t *o, stw_rt_saved_t *saved, stw_replay_rt_report_t *rep)
+{
+	memset(saved, 0, sizeof(*saved));
+	if (o->pin) apply_pin(o->cpu, saved, rep);
+	if (o->fifo_priority > 0) apply_fifo(o->fifo_priority, saved, rep);
+	if (o->lock_memory) apply_mlock(rep);
+	prefault_stack(o->prefault_bytes ? o->prefault_bytes : 64 * 1024);
+}
+
+void
+stw_rt_restore(const stw_rt_saved_t *saved)
+{
+#if defined(_WIN32)
+	if (saved->sched) SetThreadPriority(GetCurrentThread(), saved->priority);
+	if (saved->pinned) SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)saved->mask);
+#else
+	if (saved->sched) pthread_setschedparam(pthread_self(), saved->policy, &saved->param);
+#if defined(__linux__)
+	if (saved->pinned) pthread_setaffinity_np(pthread_self(), sizeof(saved->cpus), &saved->cpus);
+#endif
+#endif
+}
+
+static const char *
+status_str(stw_replay_rt_status_t st, int err)
+{
+	switch (st) {
+	case STW_RT_OK:
+		return "ok";
+	case STW_RT_FAILED:
+		return err ? strerror(err) : "failed";
+	case STW_RT_UNSUPPORTED:
+		return "unsupported";
+	default:
+		return "off";
+	}
+}
+
+void
+stw_rt_print(const stw_replay_rt_opts_t *o, const stw_replay_rt_report_t *rep)
+{
+	fprintf(
+	    stderr,
+	    "replay: realtime pin(cpu %d)=%s fifo(prio %d)=%s mlock=%s prefault(%zu B)=%s "
+	    "warmup(%u frames)=%s\n",
+	    o->cpu,
+	    status_str(rep->pin, rep->pin_errno),
+	    o->fifo_priority,
+	    status_str(rep->fifo, rep->fifo_errno),
+	    status_str(rep->mlock, rep->mlock_errno),
+	    rep->prefault_bytes,
+	    status_str(rep->prefault, 0),
+	    rep->warmup_frames,
+	    status_str(rep->warmup, 0)
+	);
+}
@@ -0,0 +1,288 @@
+#if !defined(_WIN32)
+#define _GNU_SOURCE
+#endif
+
+#include "stw/replay.h"
+#include "stw/replay_runner.h"
+
+#include "internal_clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/*
+Scheduling:
+  - Sessions are ordered largest file first (longest-processing-time first),
+    then dealt round-robin into one deque per worker.
+  - A worker pops from the head of its own deque; when empty it steals from
+    the tail of the fullest other deque. Sessions are coarse (seconds), so a
+    mutex per deque is never contended enough to matter.
+*/
+
+typedef struct {
+	size_t *idx;
+	size_t  head;
+	size_t  tail;
+#if !defined(_WIN32)
+	pthread_mutex_t mu;
+#endif
+} task_deque_t;
+
+typedef struct {
+	const stw_replay_runner_opts_t *ro;
+	stw_replay_session_t           *results;
+	task_deque_t                   *dq;
+	unsigned                        n_workers;
+	uint64_t                        t0;
+} runner_t;
+
+typedef struct {
+	runner_t *run;
+	unsigned  id;
+} worker_arg_t;
+
+static void
+dq_lock(task_deque_t *d)
+{
+#if !defined(_WIN32)
+	pthread_mutex_lock(&d->mu);
+#else
+	(void)d;
+#endif
+}
+
+static void
+dq_unlock(task_deque_t *d)
+{
+#if !defined(_WIN32)
+	pthread_mutex_unlock(&d->mu);
+#else
+	(void)d;
+#endif
+}
+
+static size_t
+dq_size(task_deque_t *d)
+{
+	dq_lock(d);
+	size_t n = d->tail - d->head;
+	dq_unlock(d);
+	return n;
+}
+
+static bool
+dq_pop_head(task_deque_t *d, size_t *out)
+{
+	bool ok = false;
+	dq_lock(d);
+	if (d->head < d->tail) {
+		*out = d->idx[d->head++];
+		ok   = true;
+	}
+	dq_unlock(d);
+	return ok;
+}
+
+static bool
+dq_steal_tail(task_deque_t *d, size_t *out)
+{
+	bool ok = false;
+	dq_lock(d);
+	if (d->head < d->tail) {
+		*out = d->idx[--d->tail];
+		ok   = true;
+	}
+	dq_unlock(d);
+	return ok;
+}
+
+static bool
+next_task(runner_t *run, unsigned self, size_t *out)
+{
+	if (dq_pop_head(&run->dq[self], out)) return true;
+	for (;;) {
+		/* pick the victim with the most work left; it may drain before we steal, so retry */
+		unsigned victim = self;
+		size_t   most   = 0;
+		for (unsigned k = 1; k < run->n_workers; k++) {
+			unsigned v    = (self + k) % run->n_workers;
+			size_t   left = dq_size(&run->dq[v]);
+			if (left > most) {
+				most   = left;
+				victim = v;
+			}
+		}
+		if (victim == self) return false;
+		if (dq_steal_tail(&run->dq[victim], out)) return true;
+	}
+}
+
+static void
+run_session(runner_t *run, unsigned worker, size_t i)
+{
+	const stw_replay_runner_opts_t *ro = run->ro;
+	stw_replay_session_t           *s  = &run->results[i];
+
+	uint64_t t_start = stw_replay_now_ns();
+	s->start_ns      = t_start - run->t0;
+	s->worker        = worker;
+
+	stw_replay_msg_cb cb  = NULL;
+	void             *ctx = NULL;
+	if (ro->create(ro->factory_user, s, &cb, &ctx) != 0 || !cb) {
+		s->wall_ns = stw_replay_now_ns() - t_start;
+		return;
+	}
+
+	stw_replay_opts_t opt = *ro->base;
+	opt.logfile           = s->logfile;
+	opt.resume            = NULL;
+	opt.checkpoint_file   = NULL;
+	opt.index_file        = NULL;
+	opt.realtime.enable   = false;
+	opt.loop              = false; /* a looping session would never hand its worker back */
+
+	stw_replay_t *R = stw_replay_create(&opt);
+	if (R) {
+		s->rc = stw_replay_run(R, cb, ctx);
+		stw_replay_checkpoint_t cp;
+		if (stw_replay_checkpoint(R, &cp) == 0) s->delivered = cp.delivered;
+		stw_replay_destroy(R);
+	}
+	s->wall_ns = stw_replay_now_ns() - t_start;
+
+	if (ro->destroy) ro->destroy(ro->factory_user, s, ctx);
+}
+
+static void *
+worker_main(void *p)
+{
+	worker_arg_t *a = (worker_arg_t *)p;
+	size_t        i = 0;
+	while (next_task(a->run, a->id, &i))
+		run_session(a->run, a->id, i);
+	return NULL;
+}
+
+static unsigned
+online_cpus(void)
+{
+#if defined(_WIN32)
+	return 1;
+#else
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (unsigned)n : 1;
+#endif
+}
+
+typedef struct {
+	size_t   i;
+	uint64_t size;
+} sized_t;
+
+static int
+by_size_desc(const void *a, const void *b)
+{
+	const sized_t *x = (const sized_t *)a;
+	const sized_t *y = (const sized_t *)b;
+	if (x->size != y->size) return x->size < y->size ? 1 : -1;
+	return x->i < y->i ? -1 : (x->i > y->i);
+}
+
+int
+stw_replay_runner_run(const stw_replay_runner_opts_t *ro, stw_replay_session_t *results)
+{
+	if (!ro || !ro->base || !ro->create || !results || (ro->n_logfiles && !ro->logfiles)) return -1;
+
+	size_t   n         = ro->n_logfiles;
+	unsigned n_workers = ro->threads ? ro->threads : online_cpus();
+#if defined(_WIN32)
+	n_workers = 1;
+#endif
+	if (n_workers > n) n_workers = n ? (unsigned)n : 1;
+
+	for (size_t i = 0; i < n; i++) {
+		memset(&results[i], 0, sizeof(results[i]));
+		results[i].index   = i;
+		results[i].logfile = ro->logfiles[i];
+		results[i].rc      = -1;
+	}
+
+	size_t        per   = (n + n_workers - 1) / n_workers; /* deque capacity */
+	sized_t      *order = (sized_t *)calloc(n ? n : 1, sizeof(*order));
+	size_t       *slots = (size_t *)calloc(per * n_workers + 1, sizeof(*slots));
+	task_deque_t *dq    = (task_deque_t *)calloc(n_workers, sizeof(*dq));
+	worker_arg_t *args  = (worker_arg_t *)calloc(n_workers, sizeof(*args));
+	if (!order || !slots || !dq || !args) {
+		free(order);
+		free(slots);
+		free(dq);
+		free(args);
+		return -1;
+	}
+
+	for (size_t i = 0; i < n; i++) {
+		struct stat st;
+		order[i].i    = i;
+		order[i].size = 0;
+		if (ro->logfiles[i] && stat(ro->logfiles[i], &st) == 0)
+			order[i].size = (uint64_t)st.st_size;
+	}
+	qsort(order, n, sizeof(*order), by_size_desc);
+
+	/* deque w owns slots[w*per .. (w+1)*per) */
+	for (unsigned w = 0; w < n_workers; w++) {
+		dq[w].idx  = slots + (size_t)w * per;
+		dq[w].head = dq[w].tail = 0;
+#if !defined(_WIN32)
+		pthread_mutex_init(&dq[w].mu, NULL);
+#endif
+	}
+	for (size_t k = 0; k < n; k++) {
+		task_deque_t *d   = &dq[k % n_workers];
+		d->idx[d->tail++] = order[k].i;
+	}
+
+	runner_t run = {
+	    .ro = ro, .results = results, .dq = dq, .n_workers = n_workers, .t0 = stw_replay_now_ns()
+	};
+
+#if !defined(_WIN32)
+	pthread_t *tids    = (pthread_t *)calloc(n_workers, sizeof(*tids));
+	bool      *started = (bool *)calloc(n_workers, sizeof(*started));
+	for (unsigned w = 1; tids && started && w < n_workers; w++) {
+		args[w].run = &run;
+		args[w].id  = w;
+		started[w]  = pthread_create(&tids[w], NULL, worker_main, &args[w]) == 0;
+		if (!started[w]) fprintf(stderr, "replay: runner worker %u failed to start\n", w);
+	}
+#endif
+	args[0].run = &run;
+	args[0].id  = 0;
+	worker_main(&args[0]);
+#if !defined(_WIN32)
+	for (unsigned w = 1; tids && started && w < n_workers; w++)
+		if (started[w]) pthread_join(tids[w], NULL);
+	for (unsigned w = 0; w < n_workers; w++)
+		pthread_mutex_destroy(&dq[w].mu);
+	free(tids);
+	free(started);
+#endif
+
+	int failed = 0;
+	for (size_t i = 0; i < n; i++)
+		if (results[i].rc != 0) failed++;
+
+	free(order);
+	free(slots);
+	free(dq);
+	free(args);
+	return failed;
+}
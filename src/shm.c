@@ -0,0 +1,474 @@
+#if !defined(_WIN32)
+#define _GNU_SOURCE
+#endif
+
+#include "stw/replay.h"
+#include "stw/replay_shm.h"
+
+#include "internal_clock.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+/*
+Ring layout (one shm object):
+
+  [ shm_hdr (3 cache lines) ][ slot 0 ][ slot 1 ] ... [ slot N-1 ]
+
+Each slot is `slot_size` bytes: a shm_slot header followed by the JSON bytes.
+Frame sequence numbers start at 1; frame `seq` lives in slot `seq & (N-1)`.
+A slot whose `seq` field is 0 is being rewritten.
+*/
+
+#if defined(_WIN32)
+
+int
+stw_replay_shm_publish(const stw_replay_opts_t *opts, const stw_replay_shm_opts_t *shm)
+{
+	(void)opts;
+	(void)shm;
+	fprintf(stderr, "replay: shared-memory publisher is not supported on this platform\n");
+	return -1;
+}
+
+stw_replay_shm_reader_t *
+stw_replay_shm_reader_open(const char *name)
+{
+	(void)name;
+	errno = ENOSYS;
+	return NULL;
+}
+
+void
+stw_replay_shm_reader_close(stw_replay_shm_reader_t *rd)
+{
+	(void)rd;
+}
+
+int
+stw_replay_shm_poll(stw_replay_shm_reader_t *rd, stw_log_frame_t *out)
+{
+	(void)rd;
+	(void)out;
+	return -1;
+}
+
+int
+stw_replay_shm_run(stw_replay_shm_reader_t *rd, stw_replay_msg_cb cb, void *user)
+{
+	(void)rd;
+	(void)cb;
+	(void)user;
+	return -1;
+}
+
+uint64_t
+stw_replay_shm_clock_ns(const stw_replay_shm_reader_t *rd)
+{
+	(void)rd;
+	return 0;
+}
+
+uint64_t
+stw_replay_shm_lost(const stw_replay_shm_reader_t *rd)
+{
+	(void)rd;
+	return 0;
+}
+
+bool
+stw_replay_shm_orphaned(const stw_replay_shm_reader_t *rd)
+{
+	(void)rd;
+	return false;
+}
+
+#else
+
+#define SHM_MAGIC        0x314d485352575453ull /* "STWRSHM1" little-endian */
+#define SHM_VERSION      3u
+#define SHM_DEF_SLOTS    16384u
+#define SHM_DEF_SLOTSIZE 2048u
+#define SHM_ALIVE_NS     100000000ull /* idle readers re-check the publisher every 100 ms */
+
+enum { SHM_STATE_INIT = 0, SHM_STATE_LIVE = 1, SHM_STATE_DONE = 2 };
+
+struct shm_hdr {
+	/* written once by the publisher before `magic` is released */
+	_Atomic uint64_t magic;
+	uint32_t         version;
+	uint32_t         slot_count;
+	uint32_t         slot_size;
+	_Atomic uint32_t epoch; /* clock seqlock: odd while clock_* are rewritten */
+	double           speed; /* 0 when replaying with no_sleep */
+	_Atomic uint32_t state;
+	_Atomic uint32_t readers;
+	_Atomic uint64_t clock_mono_ns; /* monotonic instant of the pass's 1st frame; 0 = idle */
+	_Atomic uint64_t clock_log_ns;  /* log ns of the pass's first frame */
+	_Atomic uint64_t dropped;       /* oversized frames skipped by the publisher */
+	int32_t          pid;           /* publisher process, polled by idle readers */
+	/* hot, writer-owned cache line */
+	_Alignas(64) _Atomic uint64_t head; /* seq of the last published frame; 0 = none */
+	_Atomic uint64_t last_ns;           /* log ns of the last published frame */
+	char             pad[64 - 2 * sizeof(uint64_t)];
+};
+
+struct shm_slot {
+	_Atomic uint64_t seq;
+	uint64_t         ns;
+	uint32_t         len;
+	uint32_t         pad;
+	char             data[];
+};
+
+struct stw_replay_shm_reader {
+	struct shm_hdr *H;
+	size_t          map_len;
+	uint64_t        next; /* seq of the next frame to deliver */
+	uint64_t        lost;
+	uint64_t        alive_check_ns; /* next publisher liveness check while idle */
+	bool            orphaned;       /* the publisher died without finishing */
+	char           *buf; /* private copy handed out via stw_log_frame_t */
+};
+
+static inline void
+cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+static inline struct shm_slot *
+slot_at(const struct shm_hdr *H, uint64_t seq)
+{
+	size_t idx = (size_t)(seq & (uint64_t)(H->slot_count - 1));
+	return (struct shm_slot *)((char *)(uintptr_t)H + sizeof(*H) + idx * (size_t)H->slot_size);
+}
+
+static uint32_t
+round_pow2(uint32_t v)
+{
+	uint32_t p = 1;
+	while (p < v && p < (1u << 31))
+		p <<= 1;
+	return p;
+}
+
+/* ---------------------------------------------------------------- publisher */
+
+typedef struct {
+	struct shm_hdr     *H;
+	const stw_replay_t *R;
+	uint32_t            max_len;
+	uint64_t            seq;
+	uint64_t            pass; /* loop pass + 1 whose epoch is published; 0 = none yet */
+} shm_pub_t;
+
+/* The replay restarts its pacing at the first frame of every pass; move the
+ * shared clock with it so readers never extrapolate from a previous pass. */
+static void
+publish_epoch(struct shm_hdr *H, uint64_t log_ns)
+{
+	uint32_t e = atomic_load_explicit(&H->epoch, memory_order_relaxed);
+	atomic_store_explicit(&H->epoch, e + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	atomic_store_explicit(&H->clock_log_ns, log_ns, memory_order_relaxed);
+	atomic_store_explicit(&H->clock_mono_ns, stw_replay_now_ns(), memory_order_relaxed);
+	atomic_store_explicit(&H->epoch, e + 2, memory_order_release);
+}
+
+static void
+publish_frame(void *user, const stw_log_frame_t *f)
+{
+	shm_pub_t      *P = (shm_pub_t *)user;
+	struct shm_hdr *H = P->H;
+
+	stw_replay_checkpoint_t cp;
+	stw_replay_checkpoint(P->R, &cp);
+	if (P->pass != cp.loop_iter + 1) {
+		P->pass = cp.loop_iter + 1;
+		publish_epoch(H, f->ns);
+	}
+
+	if (f->json_len > P->max_len) {
+		atomic_fetch_add_explicit(&H->dropped, 1, memory_order_relaxed);
+		return;
+	}
+
+	uint64_t         seq = ++P->seq;
+	struct shm_slot *S   = slot_at(H, seq);
+
+	/* seqlock write: invalidate, fill, publish */
+	atomic_store_explicit(&S->seq, 0, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	S->ns  = f->ns;
+	S->len = (uint32_t)f->json_len;
+	memcpy(S->data, f->json, f->json_len);
+	atomic_store_explicit(&S->seq, seq, memory_order_release);
+
+	atomic_store_explicit(&H->last_ns, f->ns, memory_order_relaxed);
+	atomic_store_explicit(&H->head, seq, memory_order_release);
+}
+
+int
+stw_replay_shm_publish(const stw_replay_opts_t *opts, const stw_replay_shm_opts_t *shm)
+{
+	if (!opts || !shm || !shm->name) return -1;
+
+	uint32_t slots     = round_pow2(shm->slot_count ? shm->slot_count : SHM_DEF_SLOTS);
+	uint32_t max_len   = shm->slot_size ? shm->slot_size : SHM_DEF_SLOTSIZE;
+	uint32_t slot_size = (uint32_t)((sizeof(struct shm_slot) + max_len + 63u) & ~(size_t)63u);
+	size_t   map_len   = sizeof(struct shm_hdr) + (size_t)slots * slot_size;
+
+	stw_replay_t *R = stw_replay_create(opts);
+	if (!R) return -1;
+
+	shm_unlink(shm->name); /* drop any stale ring so readers never see mixed runs */
+	int fd = shm_open(shm->name, O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0) {
+		fprintf(stderr, "replay: shm_open('%s') failed: %s\n", shm->name, strerror(errno));
+		stw_replay_destroy(R);
+		return -1;
+	}
+	if (ftruncate(fd, (off_t)map_len) != 0) {
+		fprintf(stderr, "replay: ftruncate('%s') failed: %s\n", shm->name, strerror(errno));
+		close(fd);
+		shm_unlink(shm->name);
+		stw_replay_destroy(R);
+		return -1;
+	}
+	void *mem = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mem == MAP_FAILED) {
+		fprintf(stderr, "replay: mmap('%s') failed: %s\n", shm->name, strerror(errno));
+		shm_unlink(shm->name);
+		stw_replay_destroy(R);
+		return -1;
+	}
+
+	/* ftruncate zero-fills, so only the non-zero fields need writing */
+	struct shm_hdr *H = (struct shm_hdr *)mem;
+	H->version        = SHM_VERSION;
+	H->slot_count     = slots;
+	H->slot_size      = slot_size;
+	H->speed          = opts->no_sleep ? 0.0 : (opts->speed > 0.0 ? opts->speed : 1.0);
+	H->pid            = (int32_t)getpid();
+	atomic_store_explicit(&H->state, SHM_STATE_LIVE, memory_order_relaxed);
+	atomic_store_explicit(&H->magic, SHM_MAGIC, memory_order_release);
+
+	while (atomic_load_explicit(&H->readers, memory_order_acquire) < shm->wait_readers) {
+		struct timespec rq = {0, 1000000}; /* 1 ms; start-up only */
+		nanosleep(&rq, NULL);
+	}
+
+	shm_pub_t P  = {.H = H, .R = R, .max_len = max_len, .seq = 0, .pass = 0};
+	int       rc = stw_replay_run_frames(R, publish_frame, &P);
+
+	atomic_store_explicit(&H->state, SHM_STATE_DONE, memory_order_release);
+	uint64_t dropped = atomic_load_explicit(&H->dropped, memory_order_relaxed);
+	if (dropped) {
+		fprintf(
+		    stderr,
+		    "replay: shm '%s': dropped %llu frames larger than %u bytes\n",
+		    shm->name,
+		    (unsigned long long)dropped,
+		    max_len
+		);
+	}
+
+	shm_unlink(shm->name);
+	munmap(mem, map_len);
+	stw_replay_destroy(R);
+	return rc;
+}
+
+/* ------------------------------------------------------------------ reader */
+
+/* A publisher killed mid-replay never sets SHM_STATE_DONE. Its pid is only
+ * meaningful inside the same PID namespace; EPERM still means it exists. */
+static bool
+publisher_alive(const struct shm_hdr *H)
+{
+	return H->pid <= 0 || kill((pid_t)H->pid, 0) == 0 || errno == EPERM;
+}
+
+stw_replay_shm_reader_t *
+stw_replay_shm_reader_open(const char *name)
+{
+	if (!name) {
+		errno = EINVAL;
+		return NULL;
+	}
+	int fd = shm_open(name, O_RDWR, 0);
+	if (fd < 0) return NULL;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(struct shm_hdr)) {
+		close(fd);
+		errno = EAGAIN;
+		return NULL;
+	}
+	size_t map_len = (size_t)st.st_size;
+	void  *mem     = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mem == MAP_FAILED) return NULL;
+
+	struct shm_hdr *H = (struct shm_hdr *)mem;
+	if (atomic_load_explicit(&H->magic, memory_order_acquire) != SHM_MAGIC ||
+	    H->version != SHM_VERSION ||
+	    sizeof(*H) + (size_t)H->slot_count * H->slot_size > map_len) {
+		munmap(mem, map_len);
+		errno = EAGAIN;
+		return NULL;
+	}
+
+	stw_replay_shm_reader_t *rd = (stw_replay_shm_reader_t *)calloc(1, sizeof(*rd));
+	if (rd) rd->buf = (char *)malloc((size_t)H->slot_size + 1);
+	if (!rd || !rd->buf) {
+		if (rd) free(rd);
+		munmap(mem, map_len);
+		errno = ENOMEM;
+		return NULL;
+	}
+	rd->H       = H;
+	rd->map_len = map_len;
+
+	uint64_t head = atomic_load_explicit(&H->head, memory_order_acquire);
+	rd->next      = (head >= H->slot_count) ? head - H->slot_count + 1 : 1;
+	atomic_fetch_add_explicit(&H->readers, 1, memory_order_release);
+	return rd;
+}
+
+void
+stw_replay_shm_reader_close(stw_replay_shm_reader_t *rd)
+{
+	if (!rd) return;
+	atomic_fetch_sub_explicit(&rd->H->readers, 1, memory_order_release);
+	munmap(rd->H, rd->map_len);
+	free(rd->buf);
+	free(rd);
+}
+
+int
+stw_replay_shm_poll(stw_replay_shm_reader_t *rd, stw_log_frame_t *out)
+{
+	if (!rd || !out) return -1;
+	struct shm_hdr *H = rd->H;
+
+	for (;;) {
+		uint64_t head = atomic_load_explicit(&H->head, memory_order_acquire);
+		if (rd->next > head) {
+			if (atomic_load_explicit(&H->state, memory_order_acquire) != SHM_STATE_DONE) {
+				uint64_t now = stw_replay_now_ns();
+				if (now < rd->alive_check_ns) return 0;
+				rd->alive_check_ns = now + SHM_ALIVE_NS;
+				if (publisher_alive(H)) return 0;
+				rd->orphaned = true;
+				/* frames published before it died are still delivered */
+				if (atomic_load_explicit(&H->head, memory_order_acquire) >= rd->next) continue;
+				return -1;
+			}
+			/* state is released after the final head store; re-check before reporting EOF */
+			if (atomic_load_explicit(&H->head, memory_order_acquire) >= rd->next) continue;
+			return -1;
+		}
+		if (head - rd->next >= H->slot_count) {
+			uint64_t oldest = head - H->slot_count + 1;
+			rd->lost += oldest - rd->next;
+			rd->next = oldest;
+		}
+
+		struct shm_slot *S  = slot_at(H, rd->next);
+		uint64_t         s1 = atomic_load_explicit(&S->seq, memory_order_acquire);
+		if (s1 != rd->next) { /* lapped between the head check and the slot read */
+			rd->lost++;
+			rd->next++;
+			continue;
+		}
+		uint64_t ns  = S->ns;
+		uint32_t len = S->len;
+		if (len > H->slot_size - sizeof(*S)) len = 0;
+		memcpy(rd->buf, S->data, len);
+		atomic_thread_fence(memory_order_acquire);
+		if (atomic_load_explicit(&S->seq, memory_order_relaxed) != s1) {
+			rd->lost++;
+			rd->next++;
+			continue;
+		}
+
+		rd->buf[len]  = '\0';
+		out->ns       = ns;
+		out->json     = rd->buf;
+		out->json_len = len;
+		rd->next++;
+		return 1;
+	}
+}
+
+int
+stw_replay_shm_run(stw_replay_shm_reader_t *rd, stw_replay_msg_cb cb, void *user)
+{
+	if (!rd || !cb) return -1;
+	stw_log_frame_t f = {0};
+	for (;;) {
+		int rc = stw_replay_shm_poll(rd, &f);
+		if (rc > 0)
+			cb(user, f.json, f.json_len);
+		else if (rc == 0)
+			cpu_relax();
+		else
+			return rd->orphaned ? -1 : 0;
+	}
+}
+
+uint64_t
+stw_replay_shm_clock_ns(const stw_replay_shm_reader_t *rd)
+{
+	if (!rd) return 0;
+	struct shm_hdr *H = rd->H;
+	uint64_t        mono, base;
+	for (;;) { /* seqlock read of the current pass's epoch */
+		uint32_t e = atomic_load_explicit(&H->epoch, memory_order_acquire);
+		if (e & 1u) {
+			cpu_relax();
+			continue;
+		}
+		mono = atomic_load_explicit(&H->clock_mono_ns, memory_order_relaxed);
+		base = atomic_load_explicit(&H->clock_log_ns, memory_order_relaxed);
+		atomic_thread_fence(memory_order_acquire);
+		if (atomic_load_explicit(&H->epoch, memory_order_relaxed) == e) break;
+	}
+	if (mono == 0) return 0;
+	if (H->speed <= 0.0) return atomic_load_explicit(&H->last_ns, memory_order_relaxed);
+	uint64_t now = stw_replay_now_ns();
+	return base + (uint64_t)((double)(now - mono) * H->speed);
+}
+
+uint64_t
+stw_replay_shm_lost(const stw_replay_shm_reader_t *rd)
+{
+	return rd ? rd->lost : 0;
+}
+
+bool
+stw_replay_shm_orphaned(const stw_replay_shm_reader_t *rd)
+{
+	return rd && rd->orphaned;
+}
+
+#endif
@@ -0,0 +1,96 @@
+#include "internal_strtab.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t
+fnv1a(const char *s, size_t n)
+{
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < n; i++) {
+		h ^= (unsigned char)s[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+static bool
+rehash(stw_strtab_t *T, uint32_t n_slots)
+{
+	uint32_t *slots = (uint32_t *)calloc(n_slots, sizeof(*slots));
+	if (!slots) return false;
+	for (uint32_t id = 0; id < T->n; id++) {
+		const char *nm = stw_strtab_name(T, id);
+		uint32_t    h  = fnv1a(nm, strlen(nm)) & (n_slots - 1);
+		while (slots[h])
+			h = (h + 1) & (n_slots - 1);
+		slots[h] = id + 1;
+	}
+	free(T->slots);
+	T->slots   = slots;
+	T->n_slots = n_slots;
+	return true;
+}
+
+bool
+stw_strtab_intern(stw_strtab_t *T, const char *s, size_t len, uint32_t *id_out)
+{
+	if ((T->n + 1) * 2 > T->n_slots && !rehash(T, T->n_slots ? T->n_slots * 2 : 256))
+		return false;
+
+	uint32_t h = fnv1a(s, len) & (T->n_slots - 1);
+	while (T->slots[h]) {
+		uint32_t    id = T->slots[h] - 1;
+		const char *nm = stw_strtab_name(T, id);
+		if (strncmp(nm, s, len) == 0 && nm[len] == '\0') {
+			*id_out = id;
+			return true;
+		}
+		h = (h + 1) & (T->n_slots - 1);
+	}
+
+	if (T->n + 2 > T->cap) { /* new id + sentinel */
+		uint32_t  ncap = T->cap ? T->cap * 2 : 256;
+		uint32_t *no   = (uint32_t *)realloc(T->off, (size_t)ncap * sizeof(*no));
+		if (!no) return false;
+		T->off = no;
+		T->cap = ncap;
+	}
+	if (T->names_len + len + 1 > T->names_cap) {
+		size_t ncap = T->names_cap ? T->names_cap * 2 : 4096;
+		while (ncap < T->names_len + len + 1)
+			ncap *= 2;
+		char *nn = (char *)realloc(T->names, ncap);
+		if (!nn) return false;
+		T->names     = nn;
+		T->names_cap = ncap;
+	}
+	T->off[T->n] = (uint32_t)T->names_len;
+	memcpy(T->names + T->names_len, s, len);
+	T->names[T->names_len + len] = '\0';
+	T->names_len += len + 1;
+	T->slots[h] = T->n + 1;
+	*id_out     = T->n++;
+	return true;
+}
+
+bool
+stw_strtab_finish(stw_strtab_t *T)
+{
+	if (!T->off) {
+		T->off = (uint32_t *)malloc(sizeof(*T->off));
+		if (!T->off) return false;
+		T->cap = 1;
+	}
+	T->off[T->n] = (uint32_t)T->names_len;
+	return true;
+}
+
+void
+stw_strtab_free(stw_strtab_t *T)
+{
+	free(T->names);
+	free(T->off);
+	free(T->slots);
+	memset(T, 0, sizeof(*T));
+}
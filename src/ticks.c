@@ -0,0 +1,380 @@
+#if !defined(_WIN32)
+#define _GNU_SOURCE
+#endif
+
+#include "stw/replay.h"
+#include "stw/replay_ticks.h"
+
+#include "internal_map.h"
+#include "internal_parser.h"
+#include "internal_strtab.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TICKS_MAGIC   0x314b434954575453ull /* "STWTICK1" little-endian */
+#define TICKS_VERSION 1u
+
+/* On-disk header, padded to the first column boundary */
+struct ticks_hdr {
+	uint64_t magic;
+	uint32_t version;
+	uint32_t block_rows;
+	uint64_t rows;
+	uint64_t n_blocks;
+	uint32_t n_symbols;
+	uint32_t reserved;
+	uint64_t off_blocks;
+	uint64_t off_ts;
+	uint64_t off_exch;
+	uint64_t off_inst;
+	uint64_t off_price;
+	uint64_t off_qty;
+	uint64_t off_dict; /* uint32 name offsets[n_symbols + 1], then NUL-terminated names */
+	uint64_t dict_len;
+	uint64_t file_len;
+};
+
+static inline uint64_t
+align_up(uint64_t v)
+{
+	return (v + (STW_TICKS_ALIGN - 1)) & ~(uint64_t)(STW_TICKS_ALIGN - 1);
+}
+
+/* ------------------------------------------------------------------ writer */
+
+typedef struct {
+	const stw_ticks_export_opts_t *xo;
+
+	uint64_t *ts;
+	uint64_t *exch;
+	uint32_t *inst;
+	double   *price;
+	int64_t  *qty;
+	uint64_t  rows;
+	uint64_t  cap;
+	uint64_t  with_inst; /* rows where inst_key / qty_key were found */
+	uint64_t  with_qty;
+
+	stw_strtab_t syms;
+	bool         failed;
+} ticks_writer_t;
+
+static bool
+grow(void **p, size_t elem, uint64_t ncap)
+{
+	void *np = realloc(*p, (size_t)ncap * elem);
+	if (!np) return false;
+	*p = np;
+	return true;
+}
+
+static void
+collect_tick(void *user, const stw_log_frame_t *f)
+{
+	ticks_writer_t                *W  = (ticks_writer_t *)user;
+	const stw_ticks_export_opts_t *xo = W->xo;
+	if (W->failed) return;
+
+	const char *v  = NULL;
+	size_t      vn = 0;
+	char       *e  = NULL;
+
+	if (!stw_json_find_scalar(f->json, f->json_len, xo->price_key, &v, &vn)) return;
+	double px = strtod(v, &e);
+	if (e == v || e > v + vn) return;
+
+	uint64_t exch = 0;
+	if (stw_json_find_scalar(f->json, f->json_len, xo->ts_key, &v, &vn))
+		exch = (uint64_t)strtoull(v, NULL, 10);
+	int64_t qty = 0;
+	if (stw_json_find_scalar(f->json, f->json_len, xo->qty_key, &v, &vn)) {
+		qty = (int64_t)strtoll(v, NULL, 10);
+		W->with_qty++;
+	}
+	uint32_t id = 0;
+	if (stw_json_find_scalar(f->json, f->json_len, xo->inst_key, &v, &vn)) {
+		W->with_inst++;
+	} else {
+		v  = "";
+		vn = 0;
+	}
+	if (!stw_strtab_intern(&W->syms, v, vn, &id)) {
+		W->failed = true;
+		return;
+	}
+
+	if (W->rows == W->cap) {
+		uint64_t ncap = W->cap ? W->cap * 2 : 65536;
+		if (!grow((void **)&W->ts, sizeof(*W->ts), ncap) ||
+		    !grow((void **)&W->exch, sizeof(*W->exch), ncap) ||
+		    !grow((void **)&W->inst, sizeof(*W->inst), ncap) ||
+		    !grow((void **)&W->price, sizeof(*W->price), ncap) ||
+		    !grow((void **)&W->qty, sizeof(*W->qty), ncap)) {
+			W->failed = true;
+			return;
+		}
+		W->cap = ncap;
+	}
+	W->ts[W->rows]    = f->ns;
+	W->exch[W->rows]  = exch;
+	W->inst[W->rows]  = id;
+	W->price[W->rows] = px;
+	W->qty[W->rows]   = qty;
+	W->rows++;
+}
+
+static bool
+write_at(FILE *fp, uint64_t *pos, uint64_t off, const void *p, size_t n)
+{
+	static const char zeros[256] = {0};
+	while (*pos < off) {
+		size_t k = (off - *pos) < sizeof(zeros) ? (size_t)(off - *pos) : sizeof(zeros);
+		if (fwrite(zeros, 1, k, fp) != k) return false;
+		*pos += k;
+	}
+	if (n && fwrite(p, 1, n, fp) != n) return false;
+	*pos += n;
+	return true;
+}
+
+static bool
+write_store(ticks_writer_t *W, const char *out_path)
+{
+	uint32_t br       = W->xo->block_rows;
+	uint64_t rows     = W->rows;
+	uint64_t n_blocks = (rows + br - 1) / br;
+
+	if (!stw_strtab_finish(&W->syms)) return false;
+
+	stw_ticks_block_t *blocks =
+	    (stw_ticks_block_t *)calloc(n_blocks ? n_blocks : 1, sizeof(stw_ticks_block_t));
+	if (!blocks) return false;
+	for (uint64_t b = 0; b < n_blocks; b++) {
+		stw_ticks_block_t *B = &blocks[b];
+		B->row_begin         = b * br;
+		B->rows              = (rows - B->row_begin) < br ? rows - B->row_begin : br;
+		B->min_ns            = UINT64_MAX;
+		for (uint64_t i = B->row_begin; i < B->row_begin + B->rows; i++) {
+			if (W->ts[i] < B->min_ns) B->min_ns = W->ts[i];
+			if (W->ts[i] > B->max_ns) B->max_ns = W->ts[i];
+		}
+	}
+
+	struct ticks_hdr H = {0};
+	H.magic            = TICKS_MAGIC;
+	H.version          = TICKS_VERSION;
+	H.block_rows       = br;
+	H.rows             = rows;
+	H.n_blocks         = n_blocks;
+	H.n_symbols        = W->syms.n;
+	H.off_blocks       = align_up(sizeof(H));
+	H.off_ts           = align_up(H.off_blocks + n_blocks * sizeof(stw_ticks_block_t));
+	H.off_exch         = align_up(H.off_ts + rows * sizeof(uint64_t));
+	H.off_inst         = align_up(H.off_exch + rows * sizeof(uint64_t));
+	H.off_price        = align_up(H.off_inst + rows * sizeof(uint32_t));
+	H.off_qty          = align_up(H.off_price + rows * sizeof(double));
+	H.off_dict         = align_up(H.off_qty + rows * sizeof(int64_t));
+	H.dict_len         = (uint64_t)(W->syms.n + 1) * sizeof(uint32_t) + W->syms.names_len;
+	H.file_len         = H.off_dict + H.dict_len;
+
+	FILE *fp = fopen(out_path, "wb");
+	if (!fp) {
+		fprintf(stderr, "replay: fopen('%s') failed: %s\n", out_path, strerror(errno));
+		free(blocks);
+		return false;
+	}
+	uint64_t pos = 0;
+	bool     ok  = write_at(fp, &pos, 0, &H, sizeof(H)) &&
+	          write_at(fp, &pos, H.off_blocks, blocks, (size_t)n_blocks * sizeof(*blocks)) &&
+	          write_at(fp, &pos, H.off_ts, W->ts, (size_t)rows * sizeof(*W->ts)) &&
+	          write_at(fp, &pos, H.off_exch, W->exch, (size_t)rows * sizeof(*W->exch)) &&
+	          write_at(fp, &pos, H.off_inst, W->inst, (size_t)rows * sizeof(*W->inst)) &&
+	          write_at(fp, &pos, H.off_price, W->price, (size_t)rows * sizeof(*W->price)) &&
+	          write_at(fp, &pos, H.off_qty, W->qty, (size_t)rows * sizeof(*W->qty)) &&
+	          write_at(fp, &pos, H.off_dict, W->syms.off, (W->syms.n + 1) * sizeof(uint32_t)) &&
+	          write_at(fp, &pos, pos, W->syms.names, W->syms.names_len);
+	if (fclose(fp) != 0) ok = false;
+	if (!ok) {
+		fprintf(stderr, "replay: writing '%s' failed: %s\n", out_path, strerror(errno));
+		remove(out_path);
+	}
+	free(blocks);
+	return ok;
+}
+
+int64_t
+stw_ticks_export(
+    const stw_replay_opts_t       *opts,
+    const char                    *out_path,
+    const stw_ticks_export_opts_t *xo
+)
+{
+	if (!opts || !out_path) return -1;
+
+	stw_ticks_export_opts_t X = {0};
+	if (xo) X = *xo;
+	if (!X.ts_key) X.ts_key = "BCastTime";
+	if (!X.inst_key) X.inst_key = "symbol";
+	if (!X.price_key) X.price_key = "ltp";
+	if (!X.qty_key) X.qty_key = "ltq";
+	if (!X.block_rows) X.block_rows = 8192;
+
+	stw_replay_opts_t opt = *opts;
+	opt.no_sleep          = true;
+	opt.loop              = false;
+	opt.resume            = NULL; /* an export always covers the whole log ... */
+	opt.checkpoint_file   = NULL; /* ... and must not move a soak run's checkpoint */
+
+	ticks_writer_t W = {0};
+	W.xo             = &X;
+
+	int64_t       rc = -1;
+	stw_replay_t *R  = stw_replay_create(&opt);
+	if (R && stw_replay_run_frames(R, collect_tick, &W) == 0 && !W.failed &&
+	    write_store(&W, out_path))
+		rc = (int64_t)W.rows;
+	stw_replay_destroy(R);
+	/* The key defaults are guesses; say so instead of writing blank columns silently */
+	if (rc > 0 && W.with_inst == 0)
+		fprintf(stderr, "replay: no frame has '%s'; instruments are empty\n", X.inst_key);
+	if (rc > 0 && W.with_qty == 0)
+		fprintf(stderr, "replay: no frame has '%s'; qty is 0\n", X.qty_key);
+
+	free(W.ts);
+	free(W.exch);
+	free(W.inst);
+	free(W.price);
+	free(W.qty);
+	stw_strtab_free(&W.syms);
+	return rc;
+}
+
+/* ------------------------------------------------------------------ reader */
+
+struct stw_ticks {
+	void            *base;
+	size_t           len;
+	const uint32_t  *name_off;
+	const char      *names;
+	stw_ticks_cols_t cols;
+};
+
+static bool
+section_ok(const struct ticks_hdr *H, uint64_t off, uint64_t n, uint64_t elem)
+{
+	return off % STW_TICKS_ALIGN == 0 && off <= H->file_len && n <= (H->file_len - off) / elem;
+}
+
+/* names must be NUL-terminated inside the dictionary */
+static bool
+dict_ok(const struct ticks_hdr *H, const char *base)
+{
+	uint64_t tbl = ((uint64_t)H->n_symbols + 1) * sizeof(uint32_t);
+	if (H->dict_len < tbl || H->off_dict + H->dict_len > H->file_len) return false;
+	const uint32_t *off   = (const uint32_t *)(base + H->off_dict);
+	const char     *names = base + H->off_dict + tbl;
+	uint64_t        nlen  = H->dict_len - tbl;
+	if (off[H->n_symbols] > nlen || (nlen && names[nlen - 1] != '\0')) return false;
+	for (uint32_t i = 0; i < H->n_symbols; i++)
+		if (off[i] >= nlen) return false;
+	return true;
+}
+
+stw_ticks_t *
+stw_ticks_open(const char *path)
+{
+	if (!path) return NULL;
+	size_t len  = 0;
+	void  *base = stw_map_file(path, &len);
+	if (!base) return NULL;
+
+	const struct ticks_hdr *H  = (const struct ticks_hdr *)base;
+	bool                    ok = len >= sizeof(*H) && H->magic == TICKS_MAGIC &&
+	          H->version == TICKS_VERSION && H->file_len <= len &&
+	          section_ok(H, H->off_blocks, H->n_blocks, sizeof(stw_ticks_block_t)) &&
+	          section_ok(H, H->off_ts, H->rows, sizeof(uint64_t)) &&
+	          section_ok(H, H->off_exch, H->rows, sizeof(uint64_t)) &&
+	          section_ok(H, H->off_inst, H->rows, sizeof(uint32_t)) &&
+	          section_ok(H, H->off_price, H->rows, sizeof(double)) &&
+	          section_ok(H, H->off_qty, H->rows, sizeof(int64_t)) &&
+	          section_ok(H, H->off_dict, (uint64_t)H->n_symbols + 1, sizeof(uint32_t)) &&
+	          dict_ok(H, (const char *)base);
+
+	stw_ticks_t *T = ok ? (stw_ticks_t *)calloc(1, sizeof(*T)) : NULL;
+	if (!T) {
+		stw_unmap_file(base, len);
+		errno = ok ? ENOMEM : EINVAL;
+		return NULL;
+	}
+
+	const char *b     = (const char *)base;
+	T->base           = base;
+	T->len            = len;
+	T->name_off       = (const uint32_t *)(b + H->off_dict);
+	T->names          = b + H->off_dict + ((uint64_t)H->n_symbols + 1) * sizeof(uint32_t);
+	T->cols.rows      = H->rows;
+	T->cols.ts_ns     = (const uint64_t *)(b + H->off_ts);
+	T->cols.exch_ts   = (const uint64_t *)(b + H->off_exch);
+	T->cols.inst      = (const uint32_t *)(b + H->off_inst);
+	T->cols.price     = (const double *)(b + H->off_price);
+	T->cols.qty       = (const int64_t *)(b + H->off_qty);
+	T->cols.n_blocks  = H->n_blocks;
+	T->cols.blocks    = (const stw_ticks_block_t *)(b + H->off_blocks);
+	T->cols.n_symbols = H->n_symbols;
+	return T;
+}
+
+void
+stw_ticks_close(stw_ticks_t *T)
+{
+	if (!T) return;
+	stw_unmap_file(T->base, T->len);
+	free(T);
+}
+
+const stw_ticks_cols_t *
+stw_ticks_cols(const stw_ticks_t *T)
+{
+	return T ? &T->cols : NULL;
+}
+
+void
+stw_ticks_find_rows(
+    const stw_ticks_t *T,
+    uint64_t           from_ns,
+    uint64_t           to_ns,
+    uint64_t          *begin,
+    uint64_t          *end
+)
+{
+	uint64_t lo = 0, hi = 0;
+	bool     any = false;
+	for (uint64_t b = 0; T && b < T->cols.n_blocks; b++) {
+		const stw_ticks_block_t *B = &T->cols.blocks[b];
+		if (B->max_ns < from_ns || B->min_ns > to_ns) continue;
+		if (!any) lo = B->row_begin;
+		hi  = B->row_begin + B->rows;
+		any = true;
+	}
+	if (begin) *begin = lo;
+	if (end) *end = hi;
+}
+
+const char *
+stw_ticks_symbol(const stw_ticks_t *T, uint32_t id)
+{
+	if (!T || id >= T->cols.n_symbols) return NULL;
+	return T->names + T->name_off[id];
+}
+
+int64_t
+stw_ticks_symbol_id(const stw_ticks_t *T, const char *name)
+{
+	if (!T || !name) return -1;
+	for (uint32_t id = 0; id < T->cols.n_symbols; id++)
+		if (strcmp(T->names + T->name_off[id], name) == 0) return id;
+	return -1;
+}
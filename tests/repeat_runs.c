@@ -0,0 +1,137 @@
+/* Repeated runs on one handle, hard stop, loop and checkpoint/resume.
+ *
+ *   tests/repeat_runs.sh        (builds this against src/ and runs it)
+ *
+ * Every run on a handle must start from the file start with fresh counts;
+ * only the first run of a session created with `resume` continues from it.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "stw/replay.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define N_FRAMES 10
+
+static int failures;
+
+#define CHECK_EQ(what, got, want)                                                              \
+	do {                                                                                       \
+		unsigned long long g_ = (unsigned long long)(got), w_ = (unsigned long long)(want);   \
+		if (g_ != w_) {                                                                        \
+			fprintf(stderr, "FAIL %s: got %llu, want %llu\n", what, g_, w_);                  \
+			failures++;                                                                        \
+		}                                                                                      \
+	} while (0)
+
+static void
+count(void *user, const char *json, size_t len)
+{
+	(void)json;
+	(void)len;
+	++*(unsigned long *)user;
+}
+
+static unsigned long
+run_once(stw_replay_t *R)
+{
+	unsigned long n = 0;
+	if (stw_replay_run(R, count, &n) != 0) failures++;
+	return n;
+}
+
+static stw_replay_checkpoint_t
+checkpoint(const stw_replay_t *R)
+{
+	stw_replay_checkpoint_t cp;
+	memset(&cp, 0, sizeof(cp));
+	stw_replay_checkpoint(R, &cp);
+	return cp;
+}
+
+int
+main(void)
+{
+	char  log[] = "/tmp/stw-repeat-XXXXXX";
+	int   fd    = mkstemp(log);
+	FILE *fp    = fd >= 0 ? fdopen(fd, "w") : NULL;
+	if (!fp) {
+		perror("mkstemp");
+		return 1;
+	}
+	for (int i = 0; i < N_FRAMES; i++) {
+		fprintf(fp, "17569751870%08d | INFO  | 1:1 | src/app.c:10 | [msg] heartbeat\n", i);
+		fprintf(
+		    fp,
+		    "17569751871%08d | WS    | 1:1 | src/feed.c:123 | [msg] {\"ltp\":\"%d\"}\n",
+		    i,
+		    24000 + i
+		);
+	}
+	fclose(fp);
+
+	stw_replay_opts_t opt;
+	memset(&opt, 0, sizeof(opt));
+	opt.logfile  = log;
+	opt.no_sleep = true;
+
+	/* plain: every run sees the whole file */
+	stw_replay_t *R = stw_replay_create(&opt);
+	CHECK_EQ("plain run 1", run_once(R), N_FRAMES);
+	CHECK_EQ("plain run 2", run_once(R), N_FRAMES);
+	CHECK_EQ("plain delivered", checkpoint(R).delivered, N_FRAMES);
+	stw_replay_destroy(R);
+
+	/* hard stop applies per run */
+	opt.hard_stop_count = 4;
+	R                   = stw_replay_create(&opt);
+	CHECK_EQ("hard stop run 1", run_once(R), 4);
+	CHECK_EQ("hard stop run 2", run_once(R), 4);
+	stw_replay_destroy(R);
+
+	/* loop + hard stop: the pass counter restarts with the run */
+	opt.loop            = true;
+	opt.hard_stop_count = 25;
+	R                   = stw_replay_create(&opt);
+	CHECK_EQ("loop run 1", run_once(R), 25);
+	CHECK_EQ("loop run 1 passes", checkpoint(R).loop_iter, 2);
+	CHECK_EQ("loop run 2", run_once(R), 25);
+	CHECK_EQ("loop run 2 passes", checkpoint(R).loop_iter, 2);
+	stw_replay_destroy(R);
+	opt.loop = false;
+
+	/* resume: the first run continues the checkpoint's totals, the next starts over */
+	opt.hard_stop_count = 3;
+	R                   = stw_replay_create(&opt);
+	CHECK_EQ("before resume", run_once(R), 3);
+	stw_replay_checkpoint_t cp = checkpoint(R);
+	stw_replay_destroy(R);
+
+	opt.hard_stop_count = 8;
+	opt.resume          = &cp;
+	R                   = stw_replay_create(&opt);
+	CHECK_EQ("resumed run", run_once(R), 5);
+	CHECK_EQ("resumed delivered", checkpoint(R).delivered, 8);
+	CHECK_EQ("run after resume", run_once(R), 8);
+	stw_replay_destroy(R);
+	opt.resume          = NULL;
+	opt.hard_stop_count = 0;
+
+	/* a pull stopped early and ended, then a full run */
+	R = stw_replay_create(&opt);
+	stw_log_frame_t f;
+	for (int i = 0; i < 3; i++)
+		CHECK_EQ("pull", stw_replay_next(R, &f), 1);
+	CHECK_EQ("end", stw_replay_end(R), 0);
+	CHECK_EQ("run after pull", run_once(R), N_FRAMES);
+	stw_replay_destroy(R);
+
+	unlink(log);
+	if (failures) return 1;
+	printf("ok   repeat runs\n");
+	return 0;
+}
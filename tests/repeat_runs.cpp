@@ -0,0 +1,83 @@
+// stw::replay::run() repeated on one object behaves like stw_replay_run().
+//
+//   tests/repeat_runs.sh        (builds this against src/ and runs it)
+
+#include "stw/replay.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <unistd.h>
+
+namespace {
+
+int failures = 0;
+
+void check_eq(const char* what, unsigned long got, unsigned long want)
+{
+    if (got != want) {
+        std::fprintf(stderr, "FAIL %s: got %lu, want %lu\n", what, got, want);
+        failures++;
+    }
+}
+
+} // namespace
+
+int main()
+{
+    char log[] = "/tmp/stw-repeat-cpp-XXXXXX";
+    int  fd    = mkstemp(log);
+    FILE* fp   = fd >= 0 ? fdopen(fd, "w") : nullptr;
+    if (!fp) {
+        std::perror("mkstemp");
+        return 1;
+    }
+    for (int i = 0; i < 10; i++)
+        std::fprintf(fp, "17569751871%08d | WS    | 1:1 | src/feed.c:123 | [msg] {\"ltp\":\"%d\"}\n", i, i);
+    std::fclose(fp);
+
+    stw_replay_opts_t opt = {};
+    opt.logfile  = log;
+    opt.no_sleep = true;
+
+    unsigned long n = 0;
+    stw::replay   r(opt, [&](std::string_view) { n++; });
+    check_eq("run 1 rc", static_cast<unsigned long>(r.run()), 0);
+    check_eq("run 1", n, 10);
+    n = 0;
+    r.run();
+    check_eq("run 2", n, 10);
+
+    opt.hard_stop_count = 4;
+    stw::replay h(opt, [&](std::string_view) { n++; });
+    n = 0;
+    h.run();
+    check_eq("hard stop run 1", n, 4);
+    n = 0;
+    h.run();
+    check_eq("hard stop run 2", n, 4);
+
+    // a handler that throws leaves the run to the next run() or the destructor
+    int  calls = 0;
+    bool armed = true;
+    stw::replay t(opt, [&](std::string_view) {
+        calls++;
+        if (armed && calls == 2) {
+            armed = false;
+            throw 1;
+        }
+    });
+    try {
+        t.run();
+    } catch (int) {
+    }
+    calls = 0;
+    t.get_session().end();
+    t.run();
+    check_eq("run after throw", static_cast<unsigned long>(calls), 4);
+
+    unlink(log);
+    if (failures) return 1;
+    std::printf("ok   repeat runs (C++)\n");
+    return 0;
+}
@@ -0,0 +1,27 @@
+#!/bin/sh
+# Builds tests/repeat_runs.c (and tests/repeat_runs.cpp when a C++ compiler is
+# around) against src/ and runs them.
+#
+#   tests/repeat_runs.sh
+
+set -eu
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT INT TERM
+
+for src in "$root"/src/*.c; do
+	${CC:-cc} -O2 -std=c11 -I"$root/include" -c "$src" -o "$tmp/$(basename "$src" .c).o"
+done
+lib=$(ls "$tmp"/*.o)
+
+${CC:-cc} -O2 -std=c11 -I"$root/include" "$root/tests/repeat_runs.c" $lib \
+    -o "$tmp/repeat_runs" -lrt -lpthread
+"$tmp/repeat_runs"
+
+cxx=${CXX:-c++}
+if command -v "$cxx" >/dev/null 2>&1; then
+	"$cxx" -O2 -std=c++17 -I"$root/include" "$root/tests/repeat_runs.cpp" $lib \
+	    -o "$tmp/repeat_runs_cpp" -lrt -lpthread
+	"$tmp/repeat_runs_cpp"
+fi